@@ -0,0 +1,241 @@
+#include <stdio.h>
+#include <math.h>
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+#include "Auto_rng.h"
+#include "Super_rng.h"
+#include "Table_rng.h"
+#include "Sparse_rng.h"
+
+using namespace std;
+
+uint64_t AutoQuality(AutoBackend backend, uint64_t level)
+{
+    if (backend != AUTO_SUPER)
+        return 5;
+    return level == 5 ? 4 : level;
+}
+
+AutoCostModel &auto_cost_model()
+{
+    // Measured by calibrate_auto_cost_model() on the reference machine (1 core, 2 MB of L2)
+    static AutoCostModel model = {
+        4000.,                             // super_setup_ns
+        {3.5, 15., 25., 72., 2200., 6.5},  // super_permute_ns
+        14.,                               // super_concat_ns
+        6.5,                               // table_slot_ns
+        20.,                               // table_cached_ns
+        95.,                               // table_memory_ns
+        2ull << 20,                        // cache_bytes
+        2800.,                             // sparse_setup_ns
+        350.,                              // sparse_value_ns
+        48.,                               // sparse_entry_bytes
+    };
+    return model;
+}
+
+AutoChoice ChooseAuto(long double values, long double samples, uint64_t word_bytes, uint64_t min_quality,
+                      uint64_t memory_budget, const AutoCostModel &model)
+{
+    AutoChoice best = {AUTO_SUPER, 5, INFINITY, 0.};
+    auto consider = [&](AutoChoice c)
+    {
+        if (AutoQuality(c.backend, c.level) >= min_quality && c.bytes <= (double)memory_budget && c.cost_ns < best.cost_ns)
+            best = c;
+    };
+
+    // Super_rng works on 2^b values, b the even number of bits of N: the values above N are walked or drawn again.
+    // The cycle walking mode is the one of Super_rng::init(): the counter fills the upper half of the word.
+    uint64_t bits = (values <= 2.L) ? 1 : (uint64_t)ceill(log2l(values));
+    bits += bits % 2;
+    long double word = ldexpl(1.L, (int)bits);
+    long double ratio = word / values;
+    bool walking = (word - values) + samples >= word / 2.L;
+    for (uint64_t level = 0; level <= 5; level++)
+    {
+        double per_value = (double)ratio * model.super_permute_ns[level] + (walking ? 0. : model.super_concat_ns);
+        consider({AUTO_SUPER, level, model.super_setup_ns + (double)samples * per_value, (double)sizeof(Super_rng)});
+    }
+
+    double table_bytes = (double)values * (double)word_bytes;
+    if (values <= 18446744073709551615.L)
+    {
+        double per_value = table_bytes <= (double)model.cache_bytes ? model.table_cached_ns : model.table_memory_ns;
+        consider({AUTO_TABLE, 0, (double)values * model.table_slot_ns + (double)samples * per_value, table_bytes});
+    }
+
+    double sparse_bytes = (double)samples * (model.sparse_entry_bytes + 2. * ((double)word_bytes - 8.));
+    consider({AUTO_SPARSE, 0, model.sparse_setup_ns + (double)samples * model.sparse_value_ns, sparse_bytes});
+
+    if (best.cost_ns == INFINITY)
+    {
+        std::cerr << "ERROR: no backend reaches the quality within the memory budget, 'SUPER5' is used" << std::endl;
+        best = {AUTO_SUPER, 5, model.super_setup_ns + (double)samples * model.super_permute_ns[5], (double)sizeof(Super_rng)};
+    }
+    return best;
+}
+
+// Time of f() in ns, the best of a few runs
+template <typename F>
+static double time_ns(F &&f, int runs = 3)
+{
+    double best = INFINITY;
+    for (int r = 0; r < runs; r++)
+    {
+        auto t1 = std::chrono::steady_clock::now();
+        f();
+        auto t2 = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::nano>(t2 - t1).count());
+    }
+    return best;
+}
+
+static volatile uint64_t calibration_sink;
+
+AutoCostModel calibrate_auto_cost_model()
+{
+    AutoCostModel m = auto_cost_model();
+    const uint64_t M = 1 << 20;
+    std::vector<uint64_t> out(M);
+
+    m.super_setup_ns = time_ns([&]()
+                               {
+                                   for (int r = 0; r < 16; r++)
+                                   {
+                                       Super_rng g(1ull << 40, 1ull << 40, 5, r);
+                                       calibration_sink = g.it();
+                                   } }) / 16;
+
+    // Full passes of 2^20 values: one permute() per value
+    for (uint64_t level = 0; level <= 5; level++)
+    {
+        const uint64_t n = (level == 4) ? 1 << 10 : (level == 3) ? 1 << 16 : M;
+        m.super_permute_ns[level] = time_ns([&]()
+                                            {
+                                                Super_rng g(M - 1, M - 1, level, 1);
+                                                g.fill(out.data(), n);
+                                                calibration_sink = out[0]; }) / n -
+                                    m.super_setup_ns / n;
+    }
+
+    // K much lower than N: the random part of each value and the it() calls
+    const uint64_t concat_n = 1 << 16;
+    double concat = time_ns([&]()
+                            {
+                                Super_rng g((1ull << 40) - 1, concat_n, 1, 1);
+                                g.fill(out.data(), concat_n);
+                                calibration_sink = out[0]; }) / concat_n;
+    m.super_concat_ns = std::max(0., concat - m.super_setup_ns / concat_n - m.super_permute_ns[1]);
+
+    // Table: filled in order, then Fisher-Yates steps in the cache and out of it
+    const uint64_t big = 8 * M; // 64 MB
+    m.table_slot_ns = time_ns([&]()
+                              {
+                                  Table_rng g(big - 1, 0, 1);
+                                  calibration_sink = g.it(); }, 1) / big;
+    const uint64_t small = 1 << 14; // 128 KB
+    m.table_cached_ns = time_ns([&]()
+                                {
+                                    Table_rng g(small - 1, small - 1, 1);
+                                    g.fill(out.data(), small);
+                                    calibration_sink = out[0]; }) / small -
+                        m.table_slot_ns;
+    {
+        Table_rng g(big - 1, big - 1, 1);
+        m.table_memory_ns = time_ns([&]()
+                                    {
+                                        g.fill(out.data(), M);
+                                        calibration_sink = out[0]; }, 1) / M;
+    }
+
+    // Sparse: hash map of the swaps
+    m.sparse_setup_ns = time_ns([&]()
+                                {
+                                    for (int r = 0; r < 16; r++)
+                                    {
+                                        Sparse_rng g((1ull << 40) - 1, 0, r);
+                                        calibration_sink = g.it();
+                                    } }) / 16;
+    const uint64_t sparse_n = 1 << 18;
+    m.sparse_value_ns = time_ns([&]()
+                                {
+                                    Sparse_rng g((1ull << 40) - 1, sparse_n - 1, 1);
+                                    g.fill(out.data(), sparse_n);
+                                    calibration_sink = out[0]; }) / sparse_n -
+                        m.sparse_setup_ns / sparse_n;
+    return m;
+}
+
+template <typename W>
+Auto_rng_t<W>::Auto_rng_t(W N, W K, uint64_t seed, uint64_t min_quality, uint64_t memory_budget)
+    : StrategyT<W>(N, K, seed), min_quality(min_quality), memory_budget(memory_budget), backend(nullptr)
+{
+    build(seed);
+}
+
+template <typename W>
+Auto_rng_t<W>::~Auto_rng_t()
+{
+    delete backend;
+}
+
+template <typename W>
+void Auto_rng_t<W>::build(uint64_t seed)
+{
+    delete backend;
+    choice = ChooseAuto((long double)N + 1.L, (long double)K + 1.L, sizeof(W), min_quality, memory_budget,
+                        auto_cost_model());
+    switch (choice.backend)
+    {
+    case AUTO_TABLE:
+        backend = new Table_rng_t<W>(N, K, seed);
+        break;
+    case AUTO_SPARSE:
+        backend = new Sparse_rng_t<W>(N, K, seed);
+        break;
+    default:
+        backend = new Super_rng_t<W>(N, K, choice.level, seed);
+        break;
+    }
+    name = std::string("Auto(") + backend->GetName() + ")";
+}
+
+template <typename W>
+W Auto_rng_t<W>::it() { return backend->it(); }
+
+template <typename W>
+void Auto_rng_t<W>::reseed(uint64_t seed)
+{
+    StrategyT<W>::reseed(seed);
+    backend->reseed(seed);
+}
+
+template <typename W>
+void Auto_rng_t<W>::reset(W N, W K, uint64_t seed)
+{
+    StrategyT<W>::reset(N, K, seed);
+    build(seed);
+}
+
+template <typename W>
+bool Auto_rng_t<W>::skip(W n) { return backend->skip(n); }
+
+template <typename W>
+void Auto_rng_t<W>::fill(W *out, uint64_t n) { backend->fill(out, n); }
+
+template <typename W>
+void Auto_rng_t<W>::fill(uint32_t *out, uint64_t n) { backend->fill(out, n); }
+
+template <typename W>
+void Auto_rng_t<W>::fill(uint16_t *out, uint64_t n) { backend->fill(out, n); }
+
+template <typename W>
+const char *Auto_rng_t<W>::GetName() const { return name.c_str(); }
+
+template <typename W>
+AutoChoice Auto_rng_t<W>::getChoice() const { return choice; }
+
+template class Auto_rng_t<uint64_t>;
+template class Auto_rng_t<uint128_t>;
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include "Strategy.h"
+
+// Costs of the backends of the AUTO strategy, in ns. auto_cost_model() holds constants measured on
+// a reference machine, calibrate_auto_cost_model() measures them on the current one ('bench_compare --calibrate').
+struct AutoCostModel
+{
+    double super_setup_ns;      // Construction of a Super_rng: Mersenne Twister seeding and keys
+    double super_permute_ns[6]; // Per permute() of each level, within a fill()
+    double super_concat_ns;     // Per value in the bitconcat mode (K much lower than N): random bits and it() call
+    double table_slot_ns;       // Per value of the domain, to fill the table
+    double table_cached_ns;     // Per value, table within the cache
+    double table_memory_ns;     // Per value, table out of the cache
+    uint64_t cache_bytes;
+    double sparse_setup_ns;
+    double sparse_value_ns;
+    double sparse_entry_bytes; // Per sampled value, for 64-bit words
+};
+
+enum AutoBackend
+{
+    AUTO_SUPER,  // On-the-fly Super_rng of the given level
+    AUTO_TABLE,  // Table_rng: materialized domain, lazy Fisher-Yates
+    AUTO_SPARSE  // Sparse_rng: Fisher-Yates on a hash map of the swaps
+};
+
+struct AutoChoice
+{
+    AutoBackend backend;
+    uint64_t level;    // For AUTO_SUPER
+    double cost_ns;    // Estimated time of the K+1 values, setup included
+    double bytes;      // Estimated memory
+};
+
+// Quality scale of the AUTO strategy: the SUPERx level for x <= 4, SUPER5 counts as 4 (its OPERM5 and
+// uniformity results are those of SUPER4), and 5 is an exactly uniform sample (Table_rng, Sparse_rng).
+uint64_t AutoQuality(AutoBackend backend, uint64_t level);
+
+AutoCostModel &auto_cost_model();          // The model used by AUTO, may be replaced
+AutoCostModel calibrate_auto_cost_model(); // About a second of measures
+
+// The cheapest backend with at least min_quality and at most memory_budget bytes, for N+1 values,
+// K+1 samples and words of word_bytes. Without any, SUPER5 is chosen.
+AutoChoice ChooseAuto(long double values, long double samples, uint64_t word_bytes, uint64_t min_quality,
+                      uint64_t memory_budget, const AutoCostModel &model);
+
+// Runs the backend chosen by ChooseAuto() for its N, K and the requested quality and memory budget.
+// The values are the ones of the backend built directly with the same seed.
+template <typename W>
+class Auto_rng_t : public StrategyT<W>
+{
+public:
+    Auto_rng_t(W N, W K, uint64_t seed, uint64_t min_quality, uint64_t memory_budget);
+    ~Auto_rng_t();
+    W it();
+    void reseed(uint64_t seed);
+    void reset(W N, W K, uint64_t seed); // The backend is chosen again
+    bool skip(W n);
+    void fill(W *out, uint64_t n);
+    void fill(uint32_t *out, uint64_t n);
+    void fill(uint16_t *out, uint64_t n);
+    const char *GetName() const; // "Auto(<backend>)"
+    AutoChoice getChoice() const;
+
+private:
+    using StrategyT<W>::N;
+    using StrategyT<W>::K;
+
+    uint64_t min_quality;
+    uint64_t memory_budget;
+    AutoChoice choice;
+    StrategyT<W> *backend;
+    std::string name; // "Auto(" and the name of the backend
+
+    void build(uint64_t seed);
+};
+
+typedef Auto_rng_t<uint64_t> Auto_rng;
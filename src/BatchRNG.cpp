@@ -0,0 +1,199 @@
+#include <iostream>
+#include <algorithm>
+
+#include "BatchRNG.h"
+
+using namespace std;
+
+static const uint64_t GOLDEN_GAMMA = 0x9E3779B97F4A7C15ull;
+
+static inline uint64_t batch_hash(uint64_t x)
+{
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+static inline uint64_t batch_reverse64(uint64_t x)
+{
+    x = __builtin_bswap64(x);
+    x = ((x >> 4) & 0x0F0F0F0F0F0F0F0Full) | ((x & 0x0F0F0F0F0F0F0F0Full) << 4);
+    x = ((x >> 2) & 0x3333333333333333ull) | ((x & 0x3333333333333333ull) << 2);
+    x = ((x >> 1) & 0x5555555555555555ull) | ((x & 0x5555555555555555ull) << 1);
+    return x;
+}
+
+BatchRNG::BatchRNG(uint64_t N, uint64_t K, StrategyType st, const vector<uint64_t> &seeds) : N(N)
+{
+    level = SuperLevel(st);
+    if (level != 1 && level != 5)
+    {
+        std::cerr << "ERROR: BatchRNG only runs SUPER1 and SUPER5, 'SUPER1' is used" << std::endl;
+        level = 1;
+    }
+    if (K > N)
+    {
+        std::cerr << "ERROR: K must be lower or equal to N, N is used" << std::endl;
+        K = N;
+    }
+    nb_samples = K + 1; // can only wrap with K=2^64-1
+
+    // Same domain as Super_rng::init(), on 64-bit words
+    const uint64_t modulus = (N == 0xFFFFFFFFFFFFFFFFull) ? N : N + 1;
+    num_bits = (N <= 1) ? 1 : Strategy::bit_width(N);
+    uint64_t num_bits_base_4 = num_bits + (num_bits % 2);
+    half_bits_base_4 = num_bits_base_4 / 2;
+    half_mask = (half_bits_base_4 < 64) ? (1ull << half_bits_base_4) - 1ull : 0xFFFFFFFFFFFFFFFFull;
+    symmetry_mask = (num_bits < 64) ? (1ull << num_bits) - 1 : 0xFFFFFFFFFFFFFFFFull;
+    mix_mask = (num_bits_base_4 < 64) ? (1ull << num_bits_base_4) - 1 : 0xFFFFFFFFFFFFFFFFull;
+    mix_shift = std::max(half_bits_base_4, (uint64_t)1);
+    random_mask = symmetry_mask;
+
+    uint64_t num_ignored_values = (num_bits_base_4 < 64) ? (1ull << num_bits_base_4) - modulus : 0xFFFFFFFFFFFFFFFFull - modulus;
+    uint64_t num_bits_for_K_and_ignored_values = Strategy::bit_width(num_ignored_values + nb_samples);
+    control_mask = (num_bits_for_K_and_ignored_values < 64) ? (1ull << num_bits_for_K_and_ignored_values) - 1 : 0xFFFFFFFFFFFFFFFFull;
+    cycle_walking = num_bits_for_K_and_ignored_values >= num_bits_base_4;
+
+    const uint64_t G = seeds.size();
+    counters.assign(G, 0);
+    entropy_keys.assign(G, 0);
+    fc_keys.assign(G, 0);
+    mix_keys.assign(mix_rounds * G, 0);
+    mix_mults.assign(mix_rounds * G, 0);
+    for (uint64_t g = 0; g < G; g++)
+        init_keys(g, seeds[g]);
+}
+
+BatchRNG::~BatchRNG() {}
+
+void BatchRNG::init_keys(uint64_t id, uint64_t seed)
+{
+    const uint64_t G = counters.size();
+    uint64_t state = seed;
+    counters[id] = 0;
+    entropy_keys[id] = Strategy::splitmix64(state++);
+    fc_keys[id] = Strategy::splitmix64(state++) & half_mask;
+    for (uint64_t r = 0; r < mix_rounds; r++)
+    {
+        mix_keys[r * G + id] = Strategy::splitmix64(state++) & mix_mask;
+        mix_mults[r * G + id] = (Strategy::splitmix64(state++) | 1) & mix_mask;
+    }
+}
+
+void BatchRNG::reseed(uint32_t id, uint64_t seed)
+{
+    init_keys(id, seed);
+}
+
+template <uint64_t L>
+void BatchRNG::permute_lanes(uint64_t *x, const uint32_t *ids) const
+{
+    // Same stages as Super_rng::permute(), one lane per generator
+    const uint64_t G = counters.size();
+    if (level == 1)
+    {
+        const uint64_t shift = 64 - num_bits;
+        for (uint64_t l = 0; l < L; l++)
+        {
+            uint64_t y = x[l];
+            y = (y & ~symmetry_mask) | (batch_reverse64(y & symmetry_mask) >> shift);
+
+            uint64_t Lh = y >> half_bits_base_4, R = y & half_mask;
+            uint64_t Rn = (Lh + 2ull * R) & half_mask; // hadamard
+            uint64_t Ln = (Lh + R) & half_mask;
+            y = ((Rn ^ (Ln ^ fc_keys[ids[l]])) << half_bits_base_4) | Ln; // feistel
+
+            y = (y & ~symmetry_mask) | (batch_reverse64(y & symmetry_mask) >> shift);
+            x[l] = y;
+        }
+    }
+    else
+    {
+        for (uint64_t l = 0; l < L; l++)
+            x[l] ^= x[l] >> mix_shift;
+        for (uint64_t r = 0; r < mix_rounds; r++)
+        {
+            const uint64_t *keys = mix_keys.data() + r * G;
+            const uint64_t *mults = mix_mults.data() + r * G;
+            for (uint64_t l = 0; l < L; l++)
+            {
+                uint64_t y = x[l] ^ keys[ids[l]];
+                y = (y * mults[ids[l]]) & mix_mask;
+                x[l] = y ^ (y >> mix_shift);
+            }
+        }
+    }
+}
+
+uint64_t BatchRNG::permute(uint64_t x, uint64_t id) const
+{
+    uint32_t id32 = (uint32_t)id;
+    permute_lanes<1>(&x, &id32);
+    return x;
+}
+
+uint64_t BatchRNG::candidate(uint64_t id)
+{
+    uint64_t i = counters[id];
+    if (cycle_walking)
+    {
+        // Wraps at N+1 as Super_rng::next_counter(): the walk of a counter above N may never end
+        counters[id] = (i >= N) ? 0 : i + 1;
+        return i;
+    }
+    counters[id]++;
+    uint64_t random_part = batch_hash(entropy_keys[id] + i * GOLDEN_GAMMA) & random_mask;
+    return (~control_mask & random_part) | (control_mask & i);
+}
+
+void BatchRNG::next(const uint32_t *ids, uint64_t n, uint64_t *out)
+{
+    // Repeated ids in one call get distinct values, but in another order than one call per value
+    uint64_t x[lanes];
+    for (uint64_t t = 0; t < n; t += lanes)
+    {
+        const uint64_t L = std::min(lanes, n - t);
+        for (uint64_t l = 0; l < L; l++)
+            x[l] = candidate(ids[t + l]);
+        if (L == lanes)
+            permute_lanes<lanes>(x, ids + t);
+        else
+            for (uint64_t l = 0; l < L; l++)
+                permute_lanes<1>(x + l, ids + t + l);
+
+        // Out of range values, as RNG::it() and Super_rng::it() do
+        for (uint64_t l = 0; l < L; l++)
+        {
+            const uint32_t id = ids[t + l];
+            if (cycle_walking)
+                while (x[l] > N)
+                    x[l] = permute(x[l], id);
+            else
+                while (x[l] > N)
+                    x[l] = permute(candidate(id), id);
+            out[t + l] = x[l];
+        }
+    }
+}
+
+void BatchRNG::next_all(uint64_t *out)
+{
+    const uint64_t G = counters.size();
+    uint32_t ids[lanes];
+    for (uint64_t g = 0; g < G; g += lanes)
+    {
+        const uint64_t L = std::min(lanes, G - g);
+        for (uint64_t l = 0; l < L; l++)
+            ids[l] = (uint32_t)(g + l);
+        next(ids, L, out + g);
+    }
+}
+
+uint64_t BatchRNG::getNumGenerators() const { return counters.size(); }
+uint64_t BatchRNG::getNumSamples() const { return nb_samples; }
+uint64_t BatchRNG::getI(uint32_t id) const { return counters[id]; }
+
+const char *BatchRNG::GetName() const
+{
+    return level == 5 ? "Batch Super5" : "Batch Super1";
+}
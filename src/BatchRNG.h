@@ -0,0 +1,63 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+#include "RNG.h"
+
+using namespace std;
+
+// Many independent generators of K+1 unique values in [0,N], all with the same N, K and level.
+// Their states are stored as a struct of arrays: counters, Feistel keys, mixing keys and entropy keys
+// each in their own array, indexed by generator id. next() advances a subset of the generators in one
+// call, several of them at a time, without a virtual call or a pointer chase per value.
+// A generator follows the Super_rng pipeline (bitconcat then permute), but the random high bits
+// come from a counter-based splitmix64 stream instead of a Mersenne Twister per generator,
+// so its series differs from RNG(N, K, s, seed). Levels SUPER1 and SUPER5 are supported.
+class BatchRNG
+{
+public:
+    BatchRNG(uint64_t N, uint64_t K, StrategyType s, const vector<uint64_t> &seeds); // One generator per seed
+    ~BatchRNG();
+
+    void next(const uint32_t *ids, uint64_t n, uint64_t *out); // out[t] is the next value of the generator ids[t]
+    void next_all(uint64_t *out);                               // out[g] is the next value of the generator g
+    void reseed(uint32_t id, uint64_t seed);                    // Restarts one generator with a new seed
+
+    uint64_t getNumGenerators() const;
+    uint64_t getNumSamples() const; // Per generator
+    uint64_t getI(uint32_t id) const;
+    const char *GetName() const;
+
+private:
+    static const uint64_t lanes = 8; // Generators advanced together
+    static const uint64_t mix_rounds = 6;
+
+    uint64_t N;
+    uint64_t nb_samples;
+    uint64_t level;
+
+    // Shared by all the generators, as in Super_rng::init()
+    uint64_t num_bits;
+    uint64_t half_bits_base_4;
+    uint64_t half_mask;
+    uint64_t symmetry_mask;
+    uint64_t mix_mask;
+    uint64_t mix_shift;
+    uint64_t random_mask;
+    uint64_t control_mask;
+    bool cycle_walking;
+
+    // Struct of arrays, indexed by generator id (key r of the generator g at r*G + g)
+    vector<uint64_t> counters;
+    vector<uint64_t> entropy_keys;
+    vector<uint64_t> fc_keys;
+    vector<uint64_t> mix_keys;
+    vector<uint64_t> mix_mults;
+
+    void init_keys(uint64_t id, uint64_t seed);
+    uint64_t permute(uint64_t x, uint64_t id) const;
+    template <uint64_t L>
+    void permute_lanes(uint64_t *x, const uint32_t *ids) const;
+    uint64_t candidate(uint64_t id); // bitconcat of the counter, which moves on
+};
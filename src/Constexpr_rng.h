@@ -0,0 +1,263 @@
+#pragma once
+
+#include <stdint.h>
+#include <array>
+
+// Compile-time permutations: constexpr auto table = rngwr_constexpr::make_permutation<N, Level>(seed)
+// holds the N+1 values of RNG(N, N, SUPERLevel, seed), in the order of it(), computed by the compiler.
+// The classes below repeat the key schedule of Super_rng and its stages on 64-bit words, for N < 2^32,
+// with a constexpr std::mt19937_64. The values are checked against the runtime generator by the unit tests.
+// Within the default evaluation limit of GCC, N goes up to about 10^4 at levels 2 and 3, 2*10^3 at level 4,
+// 3*10^4 at level 5 and 10^5 at levels 0 and 1. Larger tables need a higher -fconstexpr-ops-limit (GCC)
+// or -fconstexpr-steps (Clang). The namespace is not rngwr, the tag of the C API handle (rngwr.h).
+namespace rngwr_constexpr
+{
+
+// std::mt19937_64: the same outputs for the same seed
+class ConstexprMt64
+{
+public:
+    constexpr ConstexprMt64(uint64_t seed)
+    {
+        state[0] = seed;
+        for (uint64_t j = 1; j < n; j++)
+            state[j] = 6364136223846793005ull * (state[j - 1] ^ (state[j - 1] >> 62)) + j;
+    }
+
+    constexpr uint64_t operator()()
+    {
+        if (index == n)
+            twist();
+        uint64_t y = state[index++];
+        y ^= (y >> 29) & 0x5555555555555555ull;
+        y ^= (y << 17) & 0x71D67FFFEDA60000ull;
+        y ^= (y << 37) & 0xFFF7EEE000000000ull;
+        return y ^ (y >> 43);
+    }
+
+private:
+    static const uint64_t n = 312;
+    static const uint64_t m = 156;
+    uint64_t state[n] = {};
+    uint64_t index = n;
+
+    constexpr void twist()
+    {
+        for (uint64_t j = 0; j < n; j++)
+        {
+            uint64_t y = (state[j] & 0xFFFFFFFF80000000ull) | (state[(j + 1) % n] & 0x7FFFFFFFull);
+            state[j] = state[(j + m) % n] ^ (y >> 1) ^ ((y & 1) ? 0xB5026F5AA96619E9ull : 0);
+        }
+        index = 0;
+    }
+};
+
+// Super_rng(N, N, level, seed) on 64-bit words: the same draws of the key schedule and the same stages
+class ConstexprSuper
+{
+public:
+    constexpr ConstexprSuper(uint64_t N, uint64_t level, uint64_t seed) : N(N), level(level)
+    {
+        num_bits = (N <= 1) ? 1 : bit_width(N);
+        num_bits_base_4 = bits_base_4(N);
+        half_bits_base_4 = num_bits_base_4 / 2;
+        half_mask = (1ull << half_bits_base_4) - 1;
+        symmetry_mask = (1ull << num_bits) - 1;
+        mix_mask = (1ull << num_bits_base_4) - 1;
+        mix_shift = (half_bits_base_4 > 1) ? half_bits_base_4 : 1;
+
+        // K = N: no random initial position, the draws start with the xor key (unused by the permutation)
+        ConstexprMt64 rng(seed);
+        rng();
+        build_keys_recurs(rng, half_bits_base_4, 1);
+        fc_key = rng() & half_mask;
+        if (level == 5)
+        {
+            for (uint64_t r = 0; r < mix_rounds; r++)
+            {
+                mix_keys[r] = rng() & mix_mask;
+                mix_mults[r] = (rng() | 1) & mix_mask;
+            }
+        }
+    }
+
+    // Bits of the words permuted for [0,N]: the domain is [0, 2^bits_base_4(N)[
+    static constexpr uint64_t bits_base_4(uint64_t N)
+    {
+        uint64_t bits = (N <= 1) ? 1 : bit_width(N);
+        return bits + bits % 2;
+    }
+
+    // One round of levels 2 to 4, see round_table
+    constexpr uint64_t round(uint64_t x) const
+    {
+        return symmetry(feistel_recurs(hadamard(x)));
+    }
+
+    // Super_rng::permute(): a bijection on [0, 2^bits_base_4(N)[. At levels 2 to 4, round_table may hold
+    // round() of each word of the domain, like the round table of Super_rng: a load then replaces a round.
+    constexpr uint64_t permute(uint64_t x, const uint32_t *round_table = nullptr) const
+    {
+        if (level == 1)
+            return symmetry(feistel(hadamard(symmetry(x))));
+        if (level >= 2 && level <= 4)
+        {
+            x = symmetry(x);
+            for (uint64_t r = (level == 2) ? 1 : (level == 3) ? 4 : 128; r > 0; r--)
+                x = (round_table != nullptr) ? round_table[x] : round(x);
+            return x;
+        }
+        if (level == 5)
+            return mix(x);
+        return x;
+    }
+
+    // Output of the counter index, walked back into [0,N] like the cycle walking mode of Super_rng
+    constexpr uint64_t at(uint64_t index, const uint32_t *round_table = nullptr) const
+    {
+        uint64_t x = permute(index, round_table);
+        while (x > N)
+            x = permute(x, round_table);
+        return x;
+    }
+
+    // The N+1 values of RNG(N, N, SUPERlevel, seed): SUPER5 walks, the levels 0 to 4 skip the outputs above N
+    // (on domains of up to 2^32 words, see Super_rng.h), thus their value j comes from a later counter
+    template <typename Table>
+    constexpr void fill(Table &table, const uint32_t *round_table = nullptr) const
+    {
+        uint64_t counter = 0;
+        for (uint64_t j = 0; j <= N; j++)
+        {
+            if (level == 5)
+            {
+                table[j] = at(j, round_table);
+                continue;
+            }
+            uint64_t x = permute(counter++, round_table);
+            while (x > N)
+                x = permute(counter++, round_table);
+            table[j] = x;
+        }
+    }
+
+private:
+    static const uint64_t min_recursive_word_size = 2;
+    static const uint64_t mix_rounds = 6;
+
+    uint64_t N;
+    uint64_t level;
+    uint64_t num_bits = 0;
+    uint64_t num_bits_base_4 = 0;
+    uint64_t half_bits_base_4 = 0;
+    uint64_t half_mask = 0;
+    uint64_t symmetry_mask = 0;
+    uint64_t mix_mask = 0;
+    uint64_t mix_shift = 0;
+    uint64_t fc_key = 0;
+    uint64_t recursive_keys[64] = {}; // Node ids of the recursion, up to 63 for 32-bit halves
+    uint64_t mix_keys[mix_rounds] = {};
+    uint64_t mix_mults[mix_rounds] = {};
+
+    static constexpr uint64_t bit_width(uint64_t x)
+    {
+        uint64_t bits = 0;
+        for (; x != 0; x >>= 1)
+            bits++;
+        return bits;
+    }
+
+    constexpr void build_keys_recurs(ConstexprMt64 &rng, uint64_t bits, uint64_t id)
+    {
+        // Depth first, like Super_rng::build_keys_recurs()
+        recursive_keys[id] = rng() % (1ull << bits);
+        if (bits >= min_recursive_word_size)
+        {
+            build_keys_recurs(rng, bits / 2, 2 * id);
+            build_keys_recurs(rng, bits / 2, 2 * id + 1);
+        }
+    }
+
+    constexpr uint64_t symmetry(uint64_t x) const
+    {
+        // Reversal of the 32 low bits by swaps of halves, quarters, ... then of the num_bits low bits
+        uint64_t r = x & symmetry_mask;
+        r = ((r >> 16) & 0x0000FFFFull) | ((r & 0x0000FFFFull) << 16);
+        r = ((r >> 8) & 0x00FF00FFull) | ((r & 0x00FF00FFull) << 8);
+        r = ((r >> 4) & 0x0F0F0F0Full) | ((r & 0x0F0F0F0Full) << 4);
+        r = ((r >> 2) & 0x33333333ull) | ((r & 0x33333333ull) << 2);
+        r = ((r >> 1) & 0x55555555ull) | ((r & 0x55555555ull) << 1);
+        return (x & ~symmetry_mask) | (r >> (32 - num_bits));
+    }
+
+    constexpr uint64_t hadamard(uint64_t x) const
+    {
+        uint64_t L = x >> half_bits_base_4;
+        uint64_t R = x & half_mask;
+        return (((L + 2 * R) & half_mask) << half_bits_base_4) | ((L + R) & half_mask);
+    }
+
+    constexpr uint64_t feistel(uint64_t x) const
+    {
+        uint64_t L = x >> half_bits_base_4;
+        uint64_t R = x & half_mask;
+        return ((L ^ R ^ fc_key) << half_bits_base_4) | R;
+    }
+
+    constexpr uint64_t feister_f(uint64_t x, uint64_t id, uint64_t bits) const
+    {
+        uint64_t L = x >> bits;
+        uint64_t R = x & ((1ull << bits) - 1);
+        uint64_t Rnext = L ^ (R ^ recursive_keys[id]);
+        uint64_t Lnext = R;
+        if (bits > min_recursive_word_size)
+        {
+            Lnext = feister_f(Lnext, 2 * id, bits / 2);
+            Rnext = feister_f(Rnext, 2 * id + 1, bits / 2);
+        }
+        return (Rnext << bits) | Lnext;
+    }
+
+    constexpr uint64_t feistel_recurs(uint64_t x) const
+    {
+        return feister_f(x, 1, half_bits_base_4);
+    }
+
+    constexpr uint64_t mix(uint64_t x) const
+    {
+        x ^= x >> mix_shift;
+        for (uint64_t r = 0; r < mix_rounds; r++)
+        {
+            x ^= mix_keys[r];
+            x = (x * mix_mults[r]) & mix_mask;
+            x ^= x >> mix_shift;
+        }
+        return x;
+    }
+};
+
+// The N+1 values of RNG(N, N, SUPERLevel, seed), a permutation of [0,N], in words of type T
+template <uint64_t N, uint64_t Level, typename T = uint64_t>
+constexpr std::array<T, N + 1> make_permutation(uint64_t seed)
+{
+    static_assert(N < (1ull << 32), "compile-time permutations are limited to N < 2^32");
+    static_assert(N <= (T)~(T)0, "the values of [0,N] must fit in T");
+    static_assert(Level <= 5, "the levels are the ones of SUPER0 to SUPER5");
+    const ConstexprSuper generator(N, Level, seed);
+    std::array<T, N + 1> table = {};
+    if constexpr (Level == 3 || Level == 4)
+    {
+        // 4 and 128 rounds per value: the rounds of the domain are computed once, then a round is a load
+        std::array<uint32_t, (1ull << ConstexprSuper::bits_base_4(N))> rounds = {};
+        for (uint64_t x = 0; x < rounds.size(); x++)
+            rounds[x] = (uint32_t)generator.round(x);
+        generator.fill(table, rounds.data());
+    }
+    else
+    {
+        generator.fill(table);
+    }
+    return table;
+}
+
+} // namespace rngwr_constexpr
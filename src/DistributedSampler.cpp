@@ -0,0 +1,70 @@
+#include <iostream>
+
+#include "DistributedSampler.h"
+
+using namespace std;
+
+DistributedSampler::DistributedSampler(uint64_t N, StrategyType st, uint64_t seed, uint64_t rank, uint64_t world_size)
+    : N(N), seed(seed), rank(rank), world_size(world_size), strategy(nullptr)
+{
+    level = SuperLevel(st);
+
+    if (world_size == 0 || rank >= world_size)
+    {
+        std::cerr << "ERROR: rank must be in [0,world_size[" << std::endl;
+        this->world_size = 1;
+        this->rank = 0;
+    }
+
+    // Number of positions j in [0,N] such that j % world_size == rank
+    if (this->rank > N)
+        nb_samples = 0;
+    else
+        nb_samples = (N - this->rank) / this->world_size + 1; // can only wrap with N=2^64-1 and world_size=1
+
+    set_epoch(0);
+}
+
+DistributedSampler::~DistributedSampler()
+{
+    delete strategy;
+}
+
+void DistributedSampler::set_epoch(uint64_t e)
+{
+    epoch = e;
+    pos = rank;
+
+    // All ranks derive the same epoch seed, thus the same permutation
+    uint64_t epoch_seed = Strategy::splitmix64(seed ^ Strategy::splitmix64(epoch));
+    if (strategy == nullptr)
+        strategy = new Super_rng(N, N, level, epoch_seed, true);
+    else
+        strategy->reseed(epoch_seed);
+}
+
+uint64_t DistributedSampler::at(uint64_t j) const
+{
+    // Super_rng::permute() is a bijection on [0,4^x[. Walking the cycle of j until it comes back
+    // into [0,N] restricts it to a bijection on [0,N], evaluable at any position.
+    // Since 4^x < 4*(N+1) it costs less than 4 permute() calls per value on average.
+    uint64_t x = j;
+    do
+    {
+        x = strategy->permute(x);
+    } while (x > N);
+    return x;
+}
+
+uint64_t DistributedSampler::it()
+{
+    uint64_t out = at(pos);
+    pos += world_size;
+    return out;
+}
+
+uint64_t DistributedSampler::getNumSamples() { return nb_samples; }
+uint64_t DistributedSampler::getEpoch() { return epoch; }
+uint64_t DistributedSampler::getRank() { return rank; }
+uint64_t DistributedSampler::getWorldSize() { return world_size; }
+const char *DistributedSampler::GetName() { return strategy->GetName(); }
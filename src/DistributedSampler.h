@@ -0,0 +1,40 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "RNG.h"
+#include "Super_rng.h"
+
+// Shuffling sampler for data loaders split across several worker processes.
+// Each epoch is a fresh permutation of [0,N] and a rank only evaluates its own positions
+// (rank, rank+world_size, rank+2*world_size, ...). Ranks never communicate: the shares are disjoint
+// and cover [0,N] because every rank derives the same permutation from (seed, epoch).
+class DistributedSampler
+{
+public:
+    DistributedSampler(uint64_t N, StrategyType s, uint64_t seed, uint64_t rank, uint64_t world_size);
+    ~DistributedSampler();
+
+    void set_epoch(uint64_t epoch); // Rebuilds the key schedule of this epoch and rewinds the share
+    uint64_t it();                  // Next value of the rank's share. Call it getNumSamples() times per epoch
+    uint64_t at(uint64_t j) const;  // Value at position j in [0,N] of the epoch permutation
+
+    uint64_t getNumSamples();
+    uint64_t getEpoch();
+    uint64_t getRank();
+    uint64_t getWorldSize();
+    const char *GetName();
+
+private:
+    uint64_t N; // Values goes from [0,N]
+    uint64_t seed;
+    uint64_t rank;
+    uint64_t world_size;
+    uint64_t level;
+
+    uint64_t epoch;
+    uint64_t pos; // Next position of the epoch permutation to evaluate
+    uint64_t nb_samples;
+
+    Super_rng *strategy;
+};
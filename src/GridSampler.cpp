@@ -0,0 +1,241 @@
+#include <iostream>
+#include <cmath>
+#include <algorithm>
+
+#include "GridSampler.h"
+#include "Strategy.h"
+
+using namespace std;
+
+GridSampler::GridSampler(const vector<uint64_t> &e, uint64_t K, uint64_t seed)
+    : extents(e), pos(0), split(false), split_extent(0)
+{
+    // Number of cells, saturated at 2^64
+    uint64_t cells = 1;
+    bool saturated = false;
+    for (uint64_t j = 0; j < extents.size(); j++)
+    {
+        if (extents[j] == 0)
+        {
+            std::cerr << "ERROR: grid extents must be at least 1, 1 is used" << std::endl;
+            extents[j] = 1;
+        }
+        if (extents[j] > 1)
+        {
+            radix.push_back(extents[j]);
+            dim_of_digit.push_back(j);
+        }
+        unsigned __int128 p = (unsigned __int128)cells * extents[j];
+        if (p >> 64)
+            saturated = true;
+        cells = (uint64_t)p;
+    }
+
+    if (!saturated && K >= cells)
+    {
+        std::cerr << "ERROR: K must be lower than the number of cells, " << cells - 1 << " is used" << std::endl;
+        K = cells - 1;
+    }
+    nb_samples = K + 1; // can only wrap with K=2^64-1
+
+    if (radix.size() == 1)
+    {
+        // e = hi*b + lo with b = ceil(e/a) and a = ceil(sqrt(e)), thus a*b - e < a + b
+        split = true;
+        split_extent = radix[0];
+        uint64_t a = (uint64_t)std::sqrt((double)split_extent);
+        while ((unsigned __int128)a * a < split_extent)
+            a++;
+        while (a > 1 && (unsigned __int128)(a - 1) * (a - 1) >= split_extent)
+            a--;
+        uint64_t b = split_extent / a + (split_extent % a != 0);
+        radix = {b, a};
+        dim_of_digit = {dim_of_digit[0], dim_of_digit[0]};
+    }
+
+    uint64_t state = seed;
+    for (uint64_t k = 0; k < radix.size(); k++)
+        mults.push_back(Strategy::splitmix64(state++) | 1);
+    for (uint64_t k = 0; k < rounds * radix.size(); k++)
+        keys.push_back(Strategy::splitmix64(state++));
+
+    counter.assign(radix.size(), 0);
+    digits.assign(radix.size() * max_lanes, 0);
+}
+
+GridSampler::~GridSampler() {}
+
+static inline uint64_t grid_hash(uint64_t x)
+{
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+template <uint64_t L>
+void GridSampler::permute_digits(uint64_t *y) const
+{
+    // y[k*L + l] is the digit k of the lane l. The lanes are independent cells: their dependency chains
+    // interleave instead of waiting for each other.
+    const uint64_t m = radix.size();
+    uint64_t acc[L];
+    for (uint64_t l = 0; l < L; l++)
+        acc[l] = 0;
+    for (uint64_t k = 0; k < m; k++)
+        for (uint64_t l = 0; l < L; l++)
+            acc[l] += y[k * L + l] * mults[k];
+
+    const uint64_t *key = keys.data();
+    for (uint64_t r = 0; r < rounds; r++)
+    {
+        for (uint64_t k = 0; k < m; k++, key++)
+        {
+            // The round function only reads the other digits, thus y[k] -> y[k] + f mod radix[k] is
+            // invertible. f is mapped to [0,radix[k][ with a product instead of a modulo.
+            const uint64_t R = radix[k], M = mults[k], Key = *key;
+            uint64_t *yk = y + k * L;
+#pragma GCC unroll 8 // Keeps acc[] in registers
+            for (uint64_t l = 0; l < L; l++)
+            {
+                uint64_t others = acc[l] - yk[l] * M;
+                uint64_t f = (uint64_t)(((unsigned __int128)grid_hash(others ^ Key) * R) >> 64);
+                uint64_t v = yk[l] + f;
+                v -= R & (0 - (uint64_t)(v >= R || v < f)); // Branchless, it is taken half of the time
+                acc[l] += (v - yk[l]) * M;
+                yk[l] = v;
+            }
+        }
+    }
+}
+
+bool GridSampler::in_split_range(const uint64_t *y, uint64_t stride) const
+{
+    return (unsigned __int128)y[stride] * radix[0] + y[0] < split_extent;
+}
+
+template <uint64_t L>
+void GridSampler::next_digits(uint64_t *y, uint64_t lanes)
+{
+    // Odometer over the counter, the first digit moves fastest. The lanes above 'lanes' are not used.
+    const uint64_t m = radix.size();
+    for (uint64_t l = 0; l < lanes; l++)
+    {
+        for (uint64_t k = 0; k < m; k++)
+            y[k * L + l] = counter[k];
+        for (uint64_t k = 0; k < m; k++)
+        {
+            if (++counter[k] < radix[k])
+                break;
+            counter[k] = 0;
+        }
+    }
+    pos += lanes;
+
+    permute_digits<L>(y);
+    if (split)
+    {
+        // Less than 1 + 2/sqrt(e) permutations per cell on average
+        for (uint64_t l = 0; l < lanes; l++)
+        {
+            uint64_t z[2] = {y[l], y[L + l]};
+            while (!in_split_range(z, 1))
+                permute_digits<1>(z);
+            y[l] = z[0];
+            y[L + l] = z[1];
+        }
+    }
+}
+
+void GridSampler::init_counter()
+{
+    pos = 0;
+    for (uint64_t k = 0; k < counter.size(); k++)
+        counter[k] = 0;
+}
+
+void GridSampler::it(uint64_t *coords)
+{
+    if (pos == nb_samples)
+        init_counter();
+
+    uint64_t *y = digits.data();
+    next_digits<1>(y, 1);
+
+    for (uint64_t j = 0; j < extents.size(); j++)
+        coords[j] = 0;
+    if (split)
+        coords[dim_of_digit[0]] = y[1] * radix[0] + y[0];
+    else
+        for (uint64_t k = 0; k < radix.size(); k++)
+            coords[dim_of_digit[k]] = y[k];
+}
+
+uint64_t GridSampler::fill(uint64_t *const *columns, uint64_t n)
+{
+    if (pos == nb_samples)
+        init_counter();
+    if (n > nb_samples - pos)
+        n = nb_samples - pos;
+
+    for (uint64_t j = 0; j < extents.size(); j++)
+        if (extents[j] == 1)
+            for (uint64_t t = 0; t < n; t++)
+                columns[j][t] = 0;
+
+    uint64_t *y = digits.data();
+    for (uint64_t t = 0; t < n; t += max_lanes)
+    {
+        const uint64_t lanes = std::min(max_lanes, n - t);
+        next_digits<max_lanes>(y, lanes);
+        if (split)
+        {
+            uint64_t *out = columns[dim_of_digit[0]] + t;
+            for (uint64_t l = 0; l < lanes; l++)
+                out[l] = y[max_lanes + l] * radix[0] + y[l];
+        }
+        else
+        {
+            for (uint64_t k = 0; k < radix.size(); k++)
+            {
+                uint64_t *out = columns[dim_of_digit[k]] + t;
+                for (uint64_t l = 0; l < lanes; l++)
+                    out[l] = y[k * max_lanes + l];
+            }
+        }
+    }
+    return n;
+}
+
+void GridSampler::permute(const uint64_t *coords, uint64_t *out) const
+{
+    vector<uint64_t> y(radix.size());
+    if (split)
+    {
+        uint64_t v = coords[dim_of_digit[0]];
+        y[0] = v % radix[0];
+        y[1] = v / radix[0];
+        do
+        {
+            permute_digits<1>(y.data());
+        } while (!in_split_range(y.data(), 1));
+    }
+    else
+    {
+        for (uint64_t k = 0; k < radix.size(); k++)
+            y[k] = coords[dim_of_digit[k]];
+        permute_digits<1>(y.data());
+    }
+
+    for (uint64_t j = 0; j < extents.size(); j++)
+        out[j] = 0;
+    if (split)
+        out[dim_of_digit[0]] = y[1] * radix[0] + y[0];
+    else
+        for (uint64_t k = 0; k < radix.size(); k++)
+            out[dim_of_digit[k]] = y[k];
+}
+
+uint64_t GridSampler::getNumSamples() const { return nb_samples; }
+uint64_t GridSampler::getDims() const { return extents.size(); }
+uint64_t GridSampler::getExtent(uint64_t dim) const { return extents[dim]; }
+const char *GridSampler::GetName() const { return "Grid"; }
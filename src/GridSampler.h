@@ -0,0 +1,54 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+using namespace std;
+
+// Unique cells of a grid of extents e_0 x e_1 x ... x e_{d-1}, without flattening them into one N.
+// The permutation is a mixed-radix Feistel network on the coordinates: each round adds to the
+// coordinate j a keyed hash of the other ones, modulo e_j. It is a bijection of the grid itself,
+// thus no output is rejected and no coordinate is obtained by a division.
+// A grid with a single dimension larger than 1 is split into two digits of about sqrt(e) values
+// and restricted to [0,e[ by cycle walking.
+class GridSampler
+{
+public:
+    GridSampler(const vector<uint64_t> &extents, uint64_t K, uint64_t seed); // K+1 cells
+    ~GridSampler();
+
+    void it(uint64_t *coords);                         // Next cell, coords[j] in [0,e_j[ for each dimension
+    uint64_t fill(uint64_t *const *columns, uint64_t n); // Struct of arrays: columns[j][t] is the coordinate j of the t-th cell. Returns the number of cells written
+    void permute(const uint64_t *coords, uint64_t *out) const; // Image of a cell by the grid permutation
+
+    uint64_t getNumSamples() const;
+    uint64_t getDims() const;
+    uint64_t getExtent(uint64_t dim) const;
+    const char *GetName() const;
+
+private:
+    static const uint64_t rounds = 4;    // Passes over all the digits
+    static const uint64_t max_lanes = 8; // Cells permuted together by fill()
+
+    vector<uint64_t> extents;
+    uint64_t nb_samples;
+    uint64_t pos; // Cells already emitted
+
+    // Digits of the Feistel network, the dimensions of extent 1 are dropped
+    vector<uint64_t> radix;
+    vector<uint64_t> dim_of_digit;
+    vector<uint64_t> mults; // Odd weights of the digits in the round function input
+    vector<uint64_t> keys;  // rounds * digits
+    bool split;             // Single dimension stored as the digits (lo, hi), value hi*radix[0]+lo
+    uint64_t split_extent;
+
+    vector<uint64_t> counter; // Odometer over the digits
+    vector<uint64_t> digits;  // Scratch of max_lanes cells
+
+    template <uint64_t L>
+    void permute_digits(uint64_t *y) const; // y[k*L + l] is the digit k of the cell l
+    template <uint64_t L>
+    void next_digits(uint64_t *y, uint64_t lanes); // The next lanes <= L cells of the permuted counter
+    bool in_split_range(const uint64_t *y, uint64_t stride) const;
+    void init_counter();
+};
@@ -0,0 +1,133 @@
+#include <iostream>
+
+#include "GrowingRNG.h"
+
+using namespace std;
+
+static const uint64_t MAX_N = 0xFFFFFFFFFFFFFFFEull; // N+1 values are counted on 64 bits
+
+GrowingRNG::GrowingRNG(uint64_t N, StrategyType st, uint64_t seed) : N(N), seed(seed), pass(0), draws(0)
+{
+    level = SuperLevel(st);
+    if (this->N > MAX_N)
+    {
+        std::cerr << "ERROR: N must be lower than 2^64-1, 2^64-2 is used" << std::endl;
+        this->N = MAX_N;
+    }
+    drawn = 0;
+    remaining = 0;
+    live = 0;
+    add_segment(0, this->N);
+    build_tree();
+}
+
+GrowingRNG::~GrowingRNG()
+{
+    for (Segment &s : segments)
+        delete s.perm;
+}
+
+void GrowingRNG::add_segment(uint64_t base, uint64_t last)
+{
+    uint64_t size_1 = last - base;
+    uint64_t key = Strategy::splitmix64(seed ^ Strategy::splitmix64((pass << 32) + segments.size()));
+    segments.push_back({base, size_1 + 1, new Super_rng(size_1, size_1, level, key, true)});
+    remaining += size_1 + 1;
+    live++;
+}
+
+void GrowingRNG::build_tree()
+{
+    // O(S) construction: each node adds itself to its parent. The size is a power of two, so that
+    // find_segment() needs no bound check
+    const uint64_t S = segments.size();
+    tree_size = 1;
+    while (tree_size < S)
+        tree_size <<= 1;
+    tree.assign(tree_size + 1, 0);
+    for (uint64_t s = 1; s <= tree_size; s++)
+    {
+        if (s <= S)
+            tree[s] += segments[s - 1].remaining;
+        uint64_t parent = s + (s & (~s + 1));
+        if (parent <= tree_size)
+            tree[parent] += tree[s];
+    }
+}
+
+uint64_t GrowingRNG::find_segment(uint64_t r) const
+{
+    // Branchless descent: the first s whose prefix sum exceeds r. The padding segments have no
+    // values, and r < remaining, thus the descent ends on a real segment.
+    uint64_t pos = 0;
+    for (uint64_t step = tree_size; step != 0; step >>= 1)
+    {
+        uint64_t node = tree[pos + step];
+        uint64_t take = node <= r;
+        pos += step & (0 - take);
+        r -= node & (0 - take);
+    }
+    return pos; // 0-based segment index
+}
+
+void GrowingRNG::extend_domain(uint64_t new_N)
+{
+    if (new_N > MAX_N)
+    {
+        std::cerr << "ERROR: N must be lower than 2^64-1, 2^64-2 is used" << std::endl;
+        new_N = MAX_N;
+    }
+    if (new_N <= N)
+    {
+        std::cerr << "ERROR: the new N must be greater than N, the domain is kept" << std::endl;
+        return;
+    }
+    add_segment(N + 1, new_N);
+    N = new_N;
+    build_tree();
+}
+
+uint64_t GrowingRNG::it()
+{
+    if (remaining == 0)
+    {
+        // New pass over the whole domain
+        for (Segment &s : segments)
+            delete s.perm;
+        segments.clear();
+        pass++;
+        drawn = 0;
+        live = 0;
+        add_segment(0, N);
+        build_tree();
+    }
+
+    uint64_t r = 0;
+    if (live > 1)
+    {
+        // Uniform in [0, remaining[ by multiply-high, the bias is below remaining/2^64
+        r = (uint64_t)(((uint128_t)Strategy::splitmix64(seed + (draws++) * 0x9E3779B97F4A7C15ull) * remaining) >> 64);
+    }
+    uint64_t s = find_segment(r);
+
+    Segment &seg = segments[s];
+    uint64_t v = seg.base + seg.perm->it();
+    seg.remaining--;
+    remaining--;
+    drawn++;
+    for (uint64_t t = s + 1; t <= tree_size; t += t & (~t + 1))
+        tree[t]--;
+    if (seg.remaining == 0)
+    {
+        delete seg.perm;
+        seg.perm = nullptr;
+        live--;
+    }
+    return v;
+}
+
+uint64_t GrowingRNG::getMaxValue() const { return N; }
+uint64_t GrowingRNG::getDrawn() const { return drawn; }
+uint64_t GrowingRNG::getRemaining() const { return remaining; }
+uint64_t GrowingRNG::getNumSegments() const { return live; }
+const char *GrowingRNG::GetName() const { return "Growing"; }
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+#include "RNG.h"
+#include "Super_rng.h"
+
+using namespace std;
+
+// Unique values of a domain [0,N] that grows while it is being drawn, e.g. an append-only dataset.
+// extend_domain(new_N) appends the segment ]N, new_N]: each segment has its own Super_rng permutation
+// and a count of values left. it() picks a segment with a probability proportional to the values it
+// has left (Fenwick tree over the counts), thus the next value is uniform among the ones not drawn yet.
+// Nothing is replayed and the drawn values are not stored: the memory is one permutation per segment
+// with values left, an exhausted segment frees its permutation.
+// Once the whole domain is drawn, a new pass starts over [0,N] as a single segment.
+class GrowingRNG
+{
+public:
+    GrowingRNG(uint64_t N, StrategyType s, uint64_t seed);
+    ~GrowingRNG();
+
+    uint64_t it();
+    void extend_domain(uint64_t new_N); // new_N > N, the values already drawn are not given again
+
+    uint64_t getMaxValue() const;      // N
+    uint64_t getDrawn() const;         // In the current pass
+    uint64_t getRemaining() const;     // Values not drawn yet
+    uint64_t getNumSegments() const;   // Segments with values left
+    const char *GetName() const;
+
+private:
+    struct Segment
+    {
+        uint64_t base;
+        uint64_t remaining;
+        Super_rng *perm; // On [0, size-1], nullptr once exhausted
+    };
+
+    uint64_t N;
+    uint64_t level;
+    uint64_t seed;
+    uint64_t pass;
+    uint64_t draws; // Counter of the segment choice stream
+    uint64_t drawn;
+    uint64_t remaining;
+    uint64_t live;
+
+    vector<Segment> segments;
+    vector<uint64_t> tree; // Fenwick tree of the remaining counts, 1-based
+    uint64_t tree_size;    // Power of two >= number of segments
+
+    void add_segment(uint64_t base, uint64_t last);
+    void build_tree();
+    uint64_t find_segment(uint64_t r) const; // Segment holding the r-th value left
+};
@@ -0,0 +1,451 @@
+#include <errno.h>
+#include <stddef.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include <algorithm>
+#include <iostream>
+
+#include "IdServer.h"
+
+using namespace std;
+
+// One slot of the checkpoint file
+struct CheckpointRecord
+{
+    uint64_t magic;
+    uint64_t N;
+    uint64_t K;
+    uint64_t strategy;
+    uint64_t seed;
+    uint64_t issued;
+    uint64_t i;     // State of the strategy, see StrategyT::restore()
+    uint64_t draws;
+    uint64_t rng_words; // Of rng_state, thus the restart does not replay the draws
+    uint64_t rng_state[Strategy::RNG_STATE_WORDS];
+    uint64_t sequence;
+    uint64_t checksum; // Of the fields above
+};
+
+static const uint64_t CHECKPOINT_MAGIC = 0x32504B4344495752ull; // "RWIDCKP2"
+static const uint64_t MAX_PENDING = 8 << 20; // Bytes of replies per client before its requests wait
+
+static uint64_t checksum(const CheckpointRecord &r)
+{
+    const uint64_t *words = (const uint64_t *)&r;
+    uint64_t h = 0;
+    for (size_t w = 0; w < offsetof(CheckpointRecord, checksum) / sizeof(uint64_t); w++)
+        h = Strategy::splitmix64(h ^ words[w]);
+    return h;
+}
+
+static StrategyType restorable(StrategyType s)
+{
+    if (s < SUPER0 || s > SUPER5)
+    {
+        std::cerr << "ERROR: only the SUPERx strategies can be restored from a checkpoint, 'SUPER5' is used" << std::endl;
+        return SUPER5;
+    }
+    return s;
+}
+
+static bool unix_address(const std::string &path, sockaddr_un &addr)
+{
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path))
+    {
+        std::cerr << "ERROR: socket path longer than " << sizeof(addr.sun_path) - 1 << " bytes: " << path << std::endl;
+        return false;
+    }
+    memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    return true;
+}
+
+IdServer::IdServer(const std::string &socket_path, const std::string &checkpoint_path, uint64_t N, uint64_t K,
+                   StrategyType s, uint64_t seed)
+    : socket_path(socket_path), checkpoint_path(checkpoint_path), N(N), K(K), strategy(restorable(s)), seed(seed),
+      rng(N, K, strategy, seed), running(true)
+{
+    sockaddr_un addr;
+    if (!unix_address(socket_path, addr) || !load_checkpoint())
+        return;
+
+    // A socket file accepting connections belongs to a running server, a dead one is replaced
+    int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    bool alive = probe >= 0 && connect(probe, (sockaddr *)&addr, sizeof(addr)) == 0;
+    if (probe >= 0)
+        close(probe);
+    if (alive)
+    {
+        std::cerr << "ERROR: a server already listens on " << socket_path << std::endl;
+        return;
+    }
+    unlink(socket_path.c_str());
+
+    listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    stop_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (listen_fd < 0 || epoll_fd < 0 || stop_fd < 0 || bind(listen_fd, (sockaddr *)&addr, sizeof(addr)) != 0 ||
+        listen(listen_fd, SOMAXCONN) != 0)
+    {
+        std::cerr << "ERROR: cannot listen on " << socket_path << ": " << strerror(errno) << std::endl;
+        return;
+    }
+
+    epoll_event ev = {};
+    ev.events = EPOLLIN;
+    ev.data.ptr = &listen_fd;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listen_fd, &ev);
+    ev.data.ptr = &stop_fd;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, stop_fd, &ev);
+    ready = true;
+}
+
+IdServer::~IdServer()
+{
+    for (Client *c : clients)
+    {
+        close(c->fd);
+        delete c;
+    }
+    if (ready)
+        unlink(socket_path.c_str());
+    for (int fd : {listen_fd, epoll_fd, stop_fd, checkpoint_fd})
+        if (fd >= 0)
+            close(fd);
+}
+
+bool IdServer::ok() const { return ready; }
+
+uint64_t IdServer::getIssued() const { return issued; }
+
+uint64_t IdServer::getCheckpoints() const { return checkpoints; }
+
+uint64_t IdServer::getNumSamples() const { return K == 0xFFFFFFFFFFFFFFFFull ? K : K + 1; }
+
+void IdServer::stop()
+{
+    running.store(false);
+    if (stop_fd >= 0)
+    {
+        uint64_t one = 1;
+        if (write(stop_fd, &one, sizeof(one)) < 0)
+            return; // Already signaled
+    }
+}
+
+bool IdServer::load_checkpoint()
+{
+    checkpoint_fd = open(checkpoint_path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (checkpoint_fd < 0)
+    {
+        std::cerr << "ERROR: cannot open the checkpoint " << checkpoint_path << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    CheckpointRecord slots[2];
+    ssize_t size = pread(checkpoint_fd, slots, sizeof(slots), 0);
+    const CheckpointRecord *last = nullptr;
+    for (size_t s = 0; s < 2; s++)
+    {
+        if (size >= (ssize_t)((s + 1) * sizeof(CheckpointRecord)) && slots[s].magic == CHECKPOINT_MAGIC &&
+            slots[s].checksum == checksum(slots[s]) && (last == nullptr || slots[s].sequence > last->sequence))
+            last = &slots[s];
+    }
+
+    if (last == nullptr)
+    {
+        if (size > 0)
+        {
+            std::cerr << "ERROR: the checkpoint " << checkpoint_path << " is corrupted" << std::endl;
+            return false;
+        }
+        // New sequence: the file and its directory entry are made durable before any value is given
+        if (!write_checkpoint())
+            return false;
+        size_t slash = checkpoint_path.find_last_of('/');
+        std::string dir = (slash == std::string::npos) ? "." : checkpoint_path.substr(0, std::max(slash, (size_t)1));
+        int dir_fd = open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (dir_fd >= 0)
+        {
+            fsync(dir_fd);
+            close(dir_fd);
+        }
+        return true;
+    }
+
+    if (last->N != N || last->K != K || last->strategy != (uint64_t)strategy || last->seed != seed)
+    {
+        std::cerr << "ERROR: the checkpoint " << checkpoint_path << " holds another sequence (N: " << last->N
+                  << " K: " << last->K << " seed: " << last->seed << ")" << std::endl;
+        return false;
+    }
+    issued = last->issued;
+    sequence = last->sequence;
+    if (!rng.getStrategy()->restore(last->i, last->draws, last->rng_state, last->rng_words))
+    {
+        std::cerr << "ERROR: the checkpoint " << checkpoint_path << " is corrupted" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool IdServer::write_checkpoint()
+{
+    Strategy *s = rng.getStrategy();
+    CheckpointRecord r = {CHECKPOINT_MAGIC, N, K, (uint64_t)strategy, seed, issued, s->getI(), s->getDraws(), 0, {},
+                          sequence + 1, 0};
+    r.rng_words = s->getRngState(r.rng_state);
+    r.checksum = checksum(r);
+    off_t slot = (off_t)(r.sequence % 2) * sizeof(r);
+    if (pwrite(checkpoint_fd, &r, sizeof(r), slot) != (ssize_t)sizeof(r) || fdatasync(checkpoint_fd) != 0)
+    {
+        std::cerr << "ERROR: cannot write the checkpoint " << checkpoint_path << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+    sequence++;
+    checkpoints++;
+    return true;
+}
+
+void IdServer::accept_clients()
+{
+    for (;;)
+    {
+        int fd = accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0)
+            return; // EAGAIN: no more pending connection
+        Client *c = new Client{fd, {}, 0, {}, 0, false, false};
+        epoll_event ev = {};
+        ev.events = EPOLLIN;
+        ev.data.ptr = c;
+        epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev);
+        clients.push_back(c);
+    }
+}
+
+bool IdServer::read_requests(Client *c)
+{
+    // Stops reading while the replies exceed MAX_PENDING: the client waits on its socket
+    while (c->out.size() - c->sent < MAX_PENDING)
+    {
+        ssize_t r = read(c->fd, c->in + c->in_len, sizeof(IdRequest) - c->in_len);
+        if (r == 0)
+            return false;
+        if (r < 0)
+            return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+        c->in_len += r;
+        if (c->in_len < sizeof(IdRequest))
+            continue;
+        c->in_len = 0;
+
+        IdRequest request;
+        memcpy(&request, c->in, sizeof(request));
+        if (request.magic != ID_MAGIC)
+            return false;
+        uint64_t count = std::min({(uint64_t)request.count, (uint64_t)ID_MAX_LEASE, getNumSamples() - issued});
+        IdReply reply = {ID_MAGIC, (uint32_t)count};
+        size_t at = c->out.size();
+        c->out.resize(at + sizeof(reply) + count * sizeof(uint64_t));
+        memcpy(c->out.data() + at, &reply, sizeof(reply));
+        rng.fill((uint64_t *)(c->out.data() + at + sizeof(reply)), count);
+        issued += count;
+        c->waiting |= count > 0; // A reply of 0 values needs no checkpoint
+    }
+    return true;
+}
+
+bool IdServer::flush(Client *c)
+{
+    while (c->sent < c->out.size())
+    {
+        ssize_t r = send(c->fd, c->out.data() + c->sent, c->out.size() - c->sent, MSG_NOSIGNAL);
+        if (r < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+        c->sent += r;
+    }
+    c->out.clear(); // The storage is kept for the next replies
+    c->sent = 0;
+    return true;
+}
+
+void IdServer::watch(Client *c, bool out)
+{
+    if (c->writing == out)
+        return;
+    c->writing = out;
+    epoll_event ev = {};
+    ev.events = out ? EPOLLOUT : EPOLLIN;
+    ev.data.ptr = c;
+    epoll_ctl(epoll_fd, EPOLL_CTL_MOD, c->fd, &ev);
+}
+
+void IdServer::close_client(Client *c)
+{
+    // Its values not sent yet are lost, never given again
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, c->fd, nullptr);
+    close(c->fd);
+    clients.erase(std::find(clients.begin(), clients.end(), c));
+    delete c;
+}
+
+void IdServer::run()
+{
+    if (!ready)
+        return;
+    epoll_event events[64];
+    std::vector<Client *> waiting;
+    while (running.load())
+    {
+        int n = epoll_wait(epoll_fd, events, 64, -1);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            std::cerr << "ERROR: epoll_wait: " << strerror(errno) << std::endl;
+            return;
+        }
+
+        // The requests of all the ready clients, then a single checkpoint for all their values
+        waiting.clear();
+        for (int e = 0; e < n; e++)
+        {
+            void *tag = events[e].data.ptr;
+            if (tag == &listen_fd)
+            {
+                accept_clients();
+                continue;
+            }
+            if (tag == &stop_fd)
+            {
+                running.store(false);
+                continue;
+            }
+            Client *c = (Client *)tag;
+            bool alive = c->waiting || flush(c);
+            if (alive && !c->waiting && c->out.empty())
+                alive = read_requests(c);
+            if (!alive)
+            {
+                close_client(c);
+                continue;
+            }
+            if (c->waiting)
+                waiting.push_back(c);
+            else
+                watch(c, !c->out.empty());
+        }
+
+        if (waiting.empty())
+            continue;
+        if (!write_checkpoint())
+        {
+            running.store(false); // The values are not durable: none is sent
+            return;
+        }
+        for (Client *c : waiting)
+        {
+            c->waiting = false;
+            if (!flush(c))
+                close_client(c);
+            else
+                watch(c, !c->out.empty());
+        }
+    }
+}
+
+// Blocking I/O of the whole buffer
+static bool write_all(int fd, const void *buf, size_t size)
+{
+    const uint8_t *p = (const uint8_t *)buf;
+    while (size > 0)
+    {
+        ssize_t r = send(fd, p, size, MSG_NOSIGNAL);
+        if (r < 0 && errno == EINTR)
+            continue;
+        if (r <= 0)
+            return false;
+        p += r;
+        size -= r;
+    }
+    return true;
+}
+
+static bool read_all(int fd, void *buf, size_t size)
+{
+    uint8_t *p = (uint8_t *)buf;
+    while (size > 0)
+    {
+        ssize_t r = read(fd, p, size);
+        if (r < 0 && errno == EINTR)
+            continue;
+        if (r <= 0)
+            return false;
+        p += r;
+        size -= r;
+    }
+    return true;
+}
+
+IdClient::IdClient(const std::string &socket_path, uint32_t batch_size)
+    : batch_size(std::max((uint32_t)1, std::min(batch_size, ID_MAX_LEASE)))
+{
+    sockaddr_un addr;
+    if (!unix_address(socket_path, addr))
+        return;
+    fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd >= 0 && connect(fd, (sockaddr *)&addr, sizeof(addr)) != 0)
+    {
+        close(fd);
+        fd = -1;
+    }
+}
+
+IdClient::~IdClient()
+{
+    if (fd >= 0)
+        close(fd);
+}
+
+bool IdClient::connected() const { return fd >= 0; }
+
+uint64_t IdClient::lease(uint64_t *out, uint32_t n)
+{
+    if (fd < 0)
+        return 0;
+    IdRequest request = {ID_MAGIC, std::min(n, ID_MAX_LEASE)};
+    IdReply reply;
+    if (!write_all(fd, &request, sizeof(request)) || !read_all(fd, &reply, sizeof(reply)) || reply.magic != ID_MAGIC ||
+        reply.count > request.count || !read_all(fd, out, reply.count * sizeof(uint64_t)))
+    {
+        close(fd);
+        fd = -1;
+        return 0;
+    }
+    return reply.count;
+}
+
+bool IdClient::next(uint64_t &id)
+{
+    // The values of a batch that are never taken are lost: the server gives them to nobody else
+    if (position == batch.size())
+    {
+        batch.resize(batch_size);
+        batch.resize(lease(batch.data(), batch_size));
+        position = 0;
+        if (batch.empty())
+            return false;
+    }
+    id = batch[position++];
+    return true;
+}
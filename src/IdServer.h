@@ -0,0 +1,109 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "RNG.h"
+
+// Lease protocol on a Unix stream socket: the client sends an IdRequest, the server answers an IdReply
+// followed by count 64-bit values. count is lower than asked once the sequence is exhausted, 0 after.
+// Several requests may be sent before reading the replies, they are answered in order.
+struct IdRequest
+{
+    uint32_t magic;
+    uint32_t count; // At most ID_MAX_LEASE
+};
+
+struct IdReply
+{
+    uint32_t magic;
+    uint32_t count;
+};
+
+const uint32_t ID_MAGIC = 0x44495752;  // "RWID"
+const uint32_t ID_MAX_LEASE = 1 << 20; // Larger requests are cut
+
+// Hands out the K+1 values of RNG(N, K, s, seed) to the processes of the host: each value is given to a
+// single client, also across restarts of the server. The state of the generator is written to the
+// checkpoint file and synced before the values of a lease leave the server. It holds the Mersenne Twister
+// too, thus the restart replays no draw. The requests that arrive together (one epoll_wait()) share a
+// checkpoint, thus one sync serves many clients.
+// The checkpoint keeps two slots written in turn, a torn write leaves the previous one valid.
+// Only the SUPERx strategies can be restored from a checkpoint, the others are replaced by SUPER5.
+class IdServer
+{
+public:
+    // Continues from the checkpoint if it exists, which must hold the same N, K, s and seed
+    IdServer(const std::string &socket_path, const std::string &checkpoint_path, uint64_t N, uint64_t K,
+             StrategyType s, uint64_t seed);
+    ~IdServer(); // Closes the sockets and removes the socket file
+
+    bool ok() const; // Listening, and the checkpoint was usable
+    void run();      // Serves the clients until stop()
+    void stop();     // Async-signal-safe, from any thread
+
+    uint64_t getIssued() const;      // Values given since the first start
+    uint64_t getCheckpoints() const; // Syncs of this run
+    uint64_t getNumSamples() const;  // K+1
+
+private:
+    struct Client
+    {
+        int fd;
+        uint8_t in[sizeof(IdRequest)]; // Partial request
+        size_t in_len;
+        std::vector<uint8_t> out; // Replies not sent yet
+        size_t sent;
+        bool waiting; // Replies ready, waiting for the checkpoint
+        bool writing; // Watched for EPOLLOUT instead of EPOLLIN
+    };
+
+    std::string socket_path;
+    std::string checkpoint_path;
+    uint64_t N;
+    uint64_t K;
+    StrategyType strategy;
+    uint64_t seed;
+    RNG rng;
+
+    int listen_fd = -1;
+    int epoll_fd = -1;
+    int stop_fd = -1; // eventfd written by stop()
+    int checkpoint_fd = -1;
+    bool ready = false;
+
+    uint64_t issued = 0;
+    uint64_t sequence = 0; // Of the last checkpoint, its slot is sequence % 2
+    uint64_t checkpoints = 0;
+    std::atomic<bool> running;
+    std::vector<Client *> clients;
+
+    bool load_checkpoint();
+    bool write_checkpoint();
+    void accept_clients();
+    bool read_requests(Client *c); // false when the client is gone
+    bool flush(Client *c);         // false when the client is gone
+    void watch(Client *c, bool out);
+    void close_client(Client *c);
+};
+
+// Client of IdServer. next() takes the values from leases of batch_size values, lease() asks directly.
+// One client per thread.
+class IdClient
+{
+public:
+    IdClient(const std::string &socket_path, uint32_t batch_size = 10000);
+    ~IdClient();
+
+    bool connected() const;
+    uint64_t lease(uint64_t *out, uint32_t n); // Returns the number of values written, 0 once exhausted
+    bool next(uint64_t &id);                   // false once exhausted or disconnected
+
+private:
+    int fd = -1;
+    uint32_t batch_size;
+    std::vector<uint64_t> batch;
+    size_t position = 0;
+};
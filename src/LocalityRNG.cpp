@@ -0,0 +1,134 @@
+#include <algorithm>
+#include <iostream>
+
+#include "LocalityRNG.h"
+
+using namespace std;
+
+LocalityRNG::LocalityRNG(uint64_t N, uint64_t K, uint64_t block_size, uint64_t depth, StrategyType st, uint64_t seed)
+    : N(N), block_size(block_size), depth(depth)
+{
+    uint64_t level = SuperLevel(st);
+    if (K > N)
+    {
+        std::cerr << "ERROR: K must be lower or equal to N, N is used" << std::endl;
+        K = N;
+    }
+    if (this->block_size == 0)
+    {
+        std::cerr << "ERROR: block_size must be at least 1, 1 is used" << std::endl;
+        this->block_size = 1;
+    }
+    if (this->depth == 0)
+    {
+        std::cerr << "ERROR: depth must be at least 1, 1 is used" << std::endl;
+        this->depth = 1;
+    }
+    nb_samples = K + 1; // can only wrap with K=2^64-1
+    if (this->block_size > N)
+        this->block_size = N + 1; // A single block
+
+    // N+1 values without overflowing at N=2^64-1
+    if (N == 0xFFFFFFFFFFFFFFFFull && this->block_size == 1)
+    {
+        std::cerr << "ERROR: 2^64 blocks can not be counted, block_size 2 is used" << std::endl;
+        this->block_size = 2;
+    }
+    nb_blocks = N / this->block_size + 1;
+    last_size = N % this->block_size + 1;
+
+    outer = new Super_rng(nb_blocks - 1, nb_blocks - 1, level, Strategy::splitmix64(seed), true);
+    inner = new Super_rng(this->block_size - 1, this->block_size - 1, level,
+                          Strategy::splitmix64(seed ^ 0x5bd1e995ull), true);
+    uint64_t bits = inner->getDomainBits();
+    inner_mask = (bits < 64) ? (1ull << bits) - 1ull : 0xFFFFFFFFFFFFFFFFull;
+    inner_shift = std::max(bits / 2, (uint64_t)1);
+    tweak_key = Strategy::splitmix64(seed + 1);
+    open.resize(this->depth);
+    restart();
+}
+
+LocalityRNG::~LocalityRNG()
+{
+    delete outer;
+    delete inner;
+}
+
+uint64_t LocalityRNG::walk(const Super_rng *s, uint64_t x, uint64_t max)
+{
+    do
+    {
+        x = s->permute(x);
+    } while (x > max);
+    return x;
+}
+
+bool LocalityRNG::open_next(OpenBlock &b)
+{
+    if (next_block == nb_blocks)
+    {
+        // Closed: all the blocks are open or done
+        b.size = 0;
+        b.pos = 0;
+        return false;
+    }
+    b.block = walk(outer, next_block++, nb_blocks - 1);
+    b.size = (b.block == nb_blocks - 1) ? last_size : block_size;
+    b.pos = 0;
+    // Keys of the inner permutation derived from the block, see PermutationFamily::at()
+    uint64_t h = Strategy::splitmix64(b.block ^ tweak_key);
+    b.a = h & inner_mask;
+    b.b = Strategy::splitmix64(h) & inner_mask;
+    return true;
+}
+
+uint64_t LocalityRNG::inner_at(const OpenBlock &b, uint64_t j) const
+{
+    // Bijections keyed by the block around the shared inner permutation, as PermutationFamily::tweaked()
+    // with a single permute(). The inner permutation is on [0,block_size[, it is walked back into [0,size[
+    uint64_t x = j;
+    do
+    {
+        x = ((x ^ b.a) * (b.a | 1)) & inner_mask;
+        x ^= x >> inner_shift;
+        x = inner->permute(x);
+        x = ((x + b.b) * (b.b | 1)) & inner_mask;
+        x ^= x >> inner_shift;
+    } while (x >= b.size);
+    return x;
+}
+
+void LocalityRNG::restart()
+{
+    next_block = 0;
+    turn = 0;
+    emitted = 0;
+    for (OpenBlock &b : open)
+        open_next(b);
+}
+
+uint64_t LocalityRNG::it()
+{
+    if (emitted != 0 && emitted == N + 1) // After a full pass
+        restart();
+
+    // An exhausted block is replaced by the next one. Some open block has values left as long as
+    // the pass is not over.
+    while (open[turn].pos == open[turn].size)
+    {
+        if (!open_next(open[turn]))
+            turn = (turn + 1) % depth;
+    }
+
+    OpenBlock &b = open[turn];
+    uint64_t offset = inner_at(b, b.pos);
+    b.pos++;
+    turn = (turn + 1) % depth;
+    emitted++;
+    return b.block * block_size + offset;
+}
+
+uint64_t LocalityRNG::getNumSamples() const { return nb_samples; }
+uint64_t LocalityRNG::getBlockSize() const { return block_size; }
+uint64_t LocalityRNG::getDepth() const { return depth; }
+const char *LocalityRNG::GetName() const { return "Locality"; }
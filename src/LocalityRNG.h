@@ -0,0 +1,62 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+#include "RNG.h"
+#include "Super_rng.h"
+
+using namespace std;
+
+// Two-level permutation of [0,N] trading randomness for locality of access.
+// [0,N] is cut in blocks of block_size values (e.g. the records of a 4 KB page or a 2 MB chunk).
+// An outer permutation orders the blocks and an inner permutation, keyed per block as in
+// PermutationFamily, orders the values of a block. 'depth' blocks are open at a time and it() takes turns between them: a block
+// is replaced by the next one of the outer permutation when it is exhausted.
+// depth=1 reads a block to the end before the next one; a larger depth or a smaller block is more random.
+// Each value in [0,N] is given exactly once in N+1 calls, the first K+1 are the sample.
+class LocalityRNG
+{
+public:
+    LocalityRNG(uint64_t N, uint64_t K, uint64_t block_size, uint64_t depth, StrategyType s, uint64_t seed);
+    ~LocalityRNG();
+
+    uint64_t it();
+
+    uint64_t getNumSamples() const;
+    uint64_t getBlockSize() const;
+    uint64_t getDepth() const;
+    const char *GetName() const;
+
+private:
+    struct OpenBlock
+    {
+        uint64_t block;
+        uint64_t size; // block_size, or less for the last block
+        uint64_t pos;  // Values already given
+        uint64_t a, b; // Keys of the inner permutation of the block
+    };
+
+    uint64_t N;
+    uint64_t nb_samples;
+    uint64_t block_size;
+    uint64_t depth;
+    uint64_t nb_blocks;
+    uint64_t last_size;
+
+    Super_rng *outer; // On [0, nb_blocks-1]
+    Super_rng *inner; // On [0, block_size-1]
+    uint64_t inner_mask;
+    uint64_t inner_shift;
+    uint64_t tweak_key;
+
+    vector<OpenBlock> open;
+    uint64_t turn;       // Next open block to give a value
+    uint64_t next_block; // Position in the outer permutation
+    uint64_t emitted;
+
+    static uint64_t walk(const Super_rng *s, uint64_t x, uint64_t max); // Cycle walking of s->permute() into [0,max]
+    uint64_t inner_at(const OpenBlock &b, uint64_t j) const;            // Value at position j of the block
+    bool open_next(OpenBlock &b);
+    void restart();
+};
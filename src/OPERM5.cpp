@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cstdint>
 #include <iostream>
 #include <vector>
@@ -9,34 +10,61 @@
 
 using namespace std;
 
-double gamma_p(double a, double x)
+// Regularized upper incomplete gamma Q(a, x) = 1 - P(a, x): the series of P below x = a+1, the continued
+// fraction of Q above (modified Lentz). Both converge in O(sqrt(a)) terms and Q is never computed as a
+// difference of numbers close to 1, thus the small p-values keep their precision.
+double gamma_q(double a, double x)
 {
-    double result, term, prev;
-    int n;
-
-    result = term = std::pow(x, a) * std::exp(-x) / std::tgamma(a + 1.0);
-
-    for (n = 1; n < 1000; n++)
+    if (x <= 0.)
+        return 1.;
+    const double prefactor = std::exp(a * std::log(x) - x - std::lgamma(a));
+    if (x < a + 1.)
+    {
+        double term = 1. / a;
+        double sum = term;
+        for (int n = 1; n < 1000 && term > sum * 1e-16; n++)
+        {
+            term *= x / (a + n);
+            sum += term;
+        }
+        return std::max(0., 1. - sum * prefactor);
+    }
+    const double tiny = 1e-300;
+    double b = x + 1. - a;
+    double c = 1. / tiny;
+    double d = 1. / b;
+    double h = d;
+    for (int n = 1; n < 1000; n++)
     {
-        term *= x / (a + n);
-        prev = result;
-        result += term;
-        if (result == prev)
-            return result;
+        double an = -n * (n - a);
+        b += 2.;
+        d = an * d + b;
+        d = (std::fabs(d) < tiny) ? tiny : d;
+        c = b + an / c;
+        c = (std::fabs(c) < tiny) ? tiny : c;
+        d = 1. / d;
+        double delta = d * c;
+        h *= delta;
+        if (std::fabs(delta - 1.) < 1e-16)
+            break;
     }
+    return prefactor * h;
+}
 
-    return result;
+double chi2_pvalue(double chi2, double degrees_of_freedom)
+{
+    return gamma_q(degrees_of_freedom / 2., chi2 / 2.);
 }
 
+double normal_pvalue(double z)
+{
+    return std::erfc(std::fabs(z) / std::sqrt(2.));
+}
 
 double chi2_to_pvalue(double chi2, int degrees_of_freedom) {
-    // Compute the cumulative distribution function (CDF) of the chi-squared distribution.
-    // The CDF gives the probability of observing a value less than or equal to the chi2 value.
-    double cdf = gamma_p(static_cast<double>(degrees_of_freedom) / 2.0, chi2 / 2.0);
-
     // The p-value is the probability of observing a value equal to or more extreme than the chi2 value.
-    // For a one-sided test, this is simply 1 - CDF.
-    double p_value = 1.0 - cdf;
+    // For a one-sided test, this is the upper tail: 1 - CDF.
+    double p_value = chi2_pvalue(chi2, degrees_of_freedom);
 
     // For a two-sided test, we need to compute the CDF at both tails of the distribution and add them together.
     // This assumes that the chi2 value is positive; if it is negative, we need to reverse the order of the tails.
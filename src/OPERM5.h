@@ -5,4 +5,9 @@
 #include <vector>
 
 float OPERM5Test(uint64_t *rnd, uint64_t n);
-double uniform(std::vector<uint64_t> samples, uint64_t min_val, uint64_t max_val);
\ No newline at end of file
+double uniform(std::vector<uint64_t> samples, uint64_t min_val, uint64_t max_val);
+
+// Upper tail of the chi-squared distribution, from the regularized incomplete gamma function
+double gamma_q(double a, double x);
+double chi2_pvalue(double chi2, double degrees_of_freedom);
+double normal_pvalue(double z); // Two-sided
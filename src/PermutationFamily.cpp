@@ -0,0 +1,58 @@
+#include <algorithm>
+
+#include "PermutationFamily.h"
+
+using namespace std;
+
+PermutationFamily::PermutationFamily(uint64_t N, StrategyType st, uint64_t seed) : N(N)
+{
+    strategy = new Super_rng(N, N, SuperLevel(st), seed, true);
+    uint64_t bits = strategy->getDomainBits();
+    domain_mask = (bits < 64) ? (1ull << bits) - 1ull : 0xFFFFFFFFFFFFFFFFull;
+    shift = std::max(bits / 2, (uint64_t)1);
+    tweak_key = strategy->rand64();
+}
+
+PermutationFamily::~PermutationFamily()
+{
+    delete strategy;
+}
+
+uint64_t PermutationFamily::tweaked(uint64_t x, uint64_t a, uint64_t b) const
+{
+    // Each step is a bijection of the domain. The multiplications by odd numbers and the xorshifts
+    // are not linear over xor: without them the weak levels give strongly correlated streams.
+    x = ((x ^ a) * (a | 1)) & domain_mask;
+    x ^= x >> shift;
+    x = strategy->permute(x);
+    x = ((x + b) * (b | 1)) & domain_mask;
+    x ^= x >> shift;
+    x = strategy->permute(x);
+    return x;
+}
+
+uint64_t PermutationFamily::at(uint64_t stream, uint64_t j) const
+{
+    uint64_t h = Strategy::splitmix64(stream ^ tweak_key);
+    uint64_t a = h & domain_mask;
+    uint64_t b = Strategy::splitmix64(h) & domain_mask;
+
+    // Cycle walking back into [0,N], see DistributedSampler::at()
+    uint64_t x = j;
+    do
+    {
+        x = tweaked(x, a, b);
+    } while (x > N);
+    return x;
+}
+
+uint64_t PermutationFamily::it(uint64_t stream, uint64_t &counter) const
+{
+    uint64_t out = at(stream, counter);
+    counter++;
+    return out;
+}
+
+uint64_t PermutationFamily::getNumSamples() const { return N == 0xFFFFFFFFFFFFFFFFull ? N : N + 1; }
+uint64_t PermutationFamily::getMaxValue() const { return N; }
+const char *PermutationFamily::GetName() { return strategy->GetName(); }
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "RNG.h"
+#include "Super_rng.h"
+
+// Keyed family of permutations of [0,N] sharing a single master key schedule.
+// Stream t composes the master permutation P with bijections keyed by (a_t, b_t), derived from the
+// tweak t: xor with a_t or addition of b_t, then an odd multiplication and a xorshift. It is restricted
+// to [0,N] by cycle walking.
+// A stream has no object: its whole state is the counter passed to it(), 8 bytes per stream.
+class PermutationFamily
+{
+public:
+    PermutationFamily(uint64_t N, StrategyType s, uint64_t seed);
+    ~PermutationFamily();
+
+    uint64_t at(uint64_t stream, uint64_t j) const;        // Value at position j in [0,N] of the stream
+    uint64_t it(uint64_t stream, uint64_t &counter) const; // at(stream, counter), then counter++
+
+    uint64_t getNumSamples() const; // Values per stream, the last is at position N
+    uint64_t getMaxValue() const;
+    const char *GetName();
+
+private:
+    uint64_t tweaked(uint64_t x, uint64_t a, uint64_t b) const;
+
+    uint64_t N; // Values goes from [0,N]
+    uint64_t domain_mask;
+    uint64_t shift;
+    uint64_t tweak_key;
+    Super_rng *strategy; // Master key schedule
+};
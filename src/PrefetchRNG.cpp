@@ -0,0 +1,93 @@
+#include "PrefetchRNG.h"
+
+using namespace std;
+
+PrefetchRNG::PrefetchRNG(uint64_t N, uint64_t K, StrategyType st, uint64_t seed, uint64_t ring_size, uint64_t low_water)
+    : rng(N, K, st, seed), head(0), tail(0), running(true), sleeping(false), finished(false)
+{
+    uint64_t size = 2;
+    while (size < ring_size)
+        size *= 2;
+    ring.resize(size);
+    mask = size - 1;
+    this->low_water = std::min(low_water, size - 1);
+
+    producer = std::thread(&PrefetchRNG::produce, this);
+}
+
+PrefetchRNG::~PrefetchRNG()
+{
+    stop();
+}
+
+void PrefetchRNG::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running.store(false);
+    }
+    wake_up.notify_one();
+    if (producer.joinable())
+        producer.join();
+}
+
+void PrefetchRNG::produce()
+{
+    const uint64_t samples = rng.getNumSamples();
+    uint64_t t = tail.load(std::memory_order_relaxed);
+    while (running.load(std::memory_order_relaxed) && t < samples)
+    {
+        if (t - head.load(std::memory_order_acquire) > mask)
+        {
+            // Backpressure: the ring is full, wait until the consumer drains it to the low-water mark
+            std::unique_lock<std::mutex> lock(mutex);
+            sleeping.store(true);
+            wake_up.wait(lock, [&]
+                         { return t - head.load() <= low_water || !running.load(); });
+            sleeping.store(false);
+            continue;
+        }
+        ring[t & mask] = rng.it();
+        t++;
+        tail.store(t, std::memory_order_release);
+    }
+    finished.store(true, std::memory_order_release); // After the last tail
+}
+
+bool PrefetchRNG::try_it(uint64_t &value)
+{
+    uint64_t h = head.load(std::memory_order_relaxed);
+    if (h == tail.load(std::memory_order_acquire))
+        return false;
+
+    value = ring[h & mask];
+    head.store(h + 1); // sequentially consistent: pairs with the producer checking the level after setting 'sleeping'
+
+    if (sleeping.load() && tail.load(std::memory_order_relaxed) - (h + 1) <= low_water)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        wake_up.notify_one();
+    }
+    return true;
+}
+
+bool PrefetchRNG::it(uint64_t &value)
+{
+    while (!try_it(value))
+    {
+        if (finished.load(std::memory_order_acquire))
+            return try_it(value); // The tail read after 'finished' is the last one
+        std::this_thread::yield(); // the producer is behind
+    }
+    return true;
+}
+
+bool PrefetchRNG::exhausted() const
+{
+    return finished.load(std::memory_order_acquire) && tail.load() == head.load();
+}
+
+uint64_t PrefetchRNG::getNumSamples() { return rng.getNumSamples(); }
+uint64_t PrefetchRNG::getReady() const { return tail.load() - head.load(); }
+uint64_t PrefetchRNG::getRingSize() const { return mask + 1; }
+const char *PrefetchRNG::GetName() { return rng.GetName(); }
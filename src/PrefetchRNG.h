@@ -0,0 +1,52 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "RNG.h"
+
+// Runs the RNG pipeline on a background thread which keeps a ring of ready values filled.
+// it() then only costs a pop from a lock-free single-producer/single-consumer ring.
+// The series is the same as RNG(N, K, s, seed). A single thread may call it().
+// The producer stops after the K+1 samples, or at stop(): the ring is then drained and it() fails.
+class PrefetchRNG
+{
+public:
+    // ring_size is rounded up to a power of 2. When the ring is full, the producer sleeps until
+    // the number of ready values goes down to low_water.
+    PrefetchRNG(uint64_t N, uint64_t K, StrategyType s, uint64_t seed, uint64_t ring_size = 4096, uint64_t low_water = 1024);
+    ~PrefetchRNG(); // Stops and joins the producer
+
+    bool it(uint64_t &value);     // Waits if no value is ready, false once none will come
+    bool try_it(uint64_t &value); // Returns false instead of waiting
+    void stop();                  // The values already in the ring are still given
+    bool exhausted() const;       // No value is ready and none will come
+
+    uint64_t getNumSamples();
+    uint64_t getReady() const; // Number of values in the ring
+    uint64_t getRingSize() const;
+    const char *GetName();
+
+private:
+    void produce();
+
+    RNG rng; // Only used by the producer after construction
+    std::vector<uint64_t> ring;
+    uint64_t mask;
+    uint64_t low_water;
+
+    // Positions only grow, the slot is position & mask. Separate cache lines avoid false sharing.
+    alignas(64) std::atomic<uint64_t> head; // Next value to pop, written by the consumer
+    alignas(64) std::atomic<uint64_t> tail; // Next slot to fill, written by the producer
+    alignas(64) std::atomic<bool> running;
+    std::atomic<bool> sleeping;
+    std::atomic<bool> finished; // The producer has given its last value: after the K+1 samples or stop()
+
+    std::mutex mutex; // Only to park the producer, never taken by a pop when the producer runs
+    std::condition_variable wake_up;
+    std::thread producer;
+};
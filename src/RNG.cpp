@@ -10,7 +10,30 @@
 // useful for debugging purpose:
 using namespace std;
 
-RNG::RNG(uint64_t N, uint64_t K)
+uint64_t SuperLevel(StrategyType st)
+{
+    switch (st)
+    {
+    case SUPER0:
+        return 0;
+    case SUPER1:
+        return 1;
+    case SUPER2:
+        return 2;
+    case SUPER3:
+        return 3;
+    case SUPER4:
+        return 4;
+    case SUPER5:
+        return 5;
+    default:
+        std::cerr << "ERROR: Strategy not understood, 'SUPER1' is used" << std::endl;
+        return 1;
+    }
+}
+
+template <typename W>
+RNG_t<W>::RNG_t(W N, W K)
 {
     this->N = N;
     this->K = K;
@@ -21,51 +44,75 @@ RNG::RNG(uint64_t N, uint64_t K)
     strategy = Build(SUPER1);
 }
 
-RNG::RNG(uint64_t N, uint64_t K, StrategyType st)
+template <typename W>
+RNG_t<W>::RNG_t(W N, W K, StrategyType st)
 {
     this->N = N;
     this->K = K;
     strategy = Build(st); // Auto seeded with the device
 }
 
-RNG::RNG(uint64_t N, uint64_t K, StrategyType st, uint64_t seed)
+template <typename W>
+RNG_t<W>::RNG_t(W N, W K, StrategyType st, uint64_t seed)
 {
     this->N = N;
     this->K = K;
     strategy = CreateStrategy(st, seed);
 }
 
-RNG::~RNG()
+template <typename W>
+RNG_t<W>::RNG_t(W N, W K, StrategyType st, uint64_t seed, uint64_t min_quality, uint64_t memory_budget)
+{
+    this->N = N;
+    this->K = K;
+    auto_quality = min_quality;
+    auto_budget = memory_budget;
+    strategy = CreateStrategy(st, seed);
+}
+
+template <typename W>
+RNG_t<W>::~RNG_t()
 {
     delete strategy;
 }
 
-Strategy *RNG::Build(StrategyType st)
+template <typename W>
+StrategyT<W> *RNG_t<W>::Build(StrategyType st)
 {
     std::random_device rd;
     uint64_t auto_seed = rd();
     return CreateStrategy(st, auto_seed);
 }
 
-Strategy *RNG::CreateStrategy(StrategyType st, uint64_t seed)
+template <typename W>
+StrategyT<W> *RNG_t<W>::CreateStrategy(StrategyType st, uint64_t seed)
 {
-    Strategy *s = nullptr;
+    StrategyT<W> *s = nullptr;
     switch (st)
     {
     case SUPER0:
-        s = new Super_rng(N, K, 0, seed);
+        s = new Super_rng_t<W>(N, K, 0, seed);
         break;
     case SUPER1:
-        s = new Super_rng(N, K, 1, seed);
+        s = new Super_rng_t<W>(N, K, 1, seed);
         break;
     case SUPER2:
-        s = new Super_rng(N, K, 2, seed);
+        s = new Super_rng_t<W>(N, K, 2, seed);
         break;
     case SUPER3:
-        s = new Super_rng(N, K, 3, seed);
+        s = new Super_rng_t<W>(N, K, 3, seed);
         break;
     case SUPER4:
-        s = new Super_rng(N, K, 4, seed);
+        s = new Super_rng_t<W>(N, K, 4, seed);
+        break;
+    case SUPER5:
+        s = new Super_rng_t<W>(N, K, 5, seed);
+        break;
+    case SORTED:
+        s = new Sorted_rng_t<W>(N, K, seed);
+        break;
+    case AUTO:
+        s = new Auto_rng_t<W>(N, K, seed, auto_quality, auto_budget);
         break;
     default:
         std::cerr << "ERROR: Strategy not understood" << std::endl;
@@ -74,9 +121,10 @@ Strategy *RNG::CreateStrategy(StrategyType st, uint64_t seed)
     return s;
 }
 
-uint64_t RNG::it()
+template <typename W>
+W RNG_t<W>::it()
 {
-    uint64_t rand_num;
+    W rand_num;
     do
     {
         // strategy produces numbers between [0;2^x[ (if the strategy is base 2) or [0;4^x[ (if the stragy is base 4)
@@ -91,12 +139,75 @@ uint64_t RNG::it()
     return rand_num;
 }
 
-Strategy *RNG::getStrategy()
+template <typename W>
+void RNG_t<W>::fill(W *out, uint64_t n)
+{
+    // Same values as n calls to it(), without a virtual call per value
+    strategy->fill(out, n);
+}
+
+template <typename W>
+void RNG_t<W>::fill(uint32_t *out, uint64_t n)
+{
+    if (N > (W)0xFFFFFFFFu)
+    {
+        std::cerr << "ERROR: 32-bit words need N < 2^32, nothing is written" << std::endl;
+        return;
+    }
+    strategy->fill(out, n);
+}
+
+template <typename W>
+void RNG_t<W>::fill(uint16_t *out, uint64_t n)
+{
+    if (N > (W)0xFFFFu)
+    {
+        std::cerr << "ERROR: 16-bit words need N < 2^16, nothing is written" << std::endl;
+        return;
+    }
+    strategy->fill(out, n);
+}
+
+template <typename W>
+void RNG_t<W>::skip(W n)
+{
+    // A strategy can only jump when its outputs are never rejected by it()
+    if (strategy->skip(n))
+        return;
+    for (W j = 0; j < n; j++)
+    {
+        it();
+    }
+}
+
+template <typename W>
+void RNG_t<W>::reseed(uint64_t seed)
+{
+    strategy->reseed(seed);
+}
+
+template <typename W>
+void RNG_t<W>::reset(W N, W K, uint64_t seed)
+{
+    this->N = N;
+    this->K = K;
+    strategy->reset(N, K, seed);
+}
+
+template <typename W>
+StrategyT<W> *RNG_t<W>::getStrategy()
 {
     return strategy;
 }
 
-uint64_t RNG::getNumSamples() { return strategy->getNumSamples(); }
-uint64_t RNG::getMaxValue() { return strategy->getMaxValue(); }
-uint64_t RNG::getMinValue() { return strategy->getMinValue(); }
-const char *RNG::GetName() { return strategy->GetName(); }
+template <typename W>
+W RNG_t<W>::getNumSamples() { return strategy->getNumSamples(); }
+template <typename W>
+W RNG_t<W>::getMaxValue() { return strategy->getMaxValue(); }
+template <typename W>
+W RNG_t<W>::getMinValue() { return strategy->getMinValue(); }
+template <typename W>
+const char *RNG_t<W>::GetName() { return strategy->GetName(); }
+
+template class RNG_t<uint64_t>;
+template class RNG_t<uint128_t>;
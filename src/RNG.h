@@ -7,6 +7,8 @@
 #include "Strategy.h" // Abstract class
 
 #include "Super_rng.h"
+#include "Sorted_rng.h"
+#include "Auto_rng.h"
 
 
 
@@ -20,32 +22,63 @@ enum StrategyType
     SUPER1,
     SUPER2,
     SUPER3,
-    SUPER4
+    SUPER4,
+    SUPER5, // Multiply/xorshift rounds: the quality of SUPER4 at the cost of SUPER1
+    SORTED, // K+1 values in increasing order
+    AUTO    // The cheapest of the SUPERx levels, a table and a sparse Fisher-Yates for N, K, a quality and a memory budget
 };
 
-class RNG
+// Mixing level of a SUPERx strategy, for the classes built directly on Super_rng.
+// Other strategies are not understood: 'SUPER1' is used.
+uint64_t SuperLevel(StrategyType s);
+
+// W is the word type of the values: RNG draws from 64-bit domains, RNG128 up to N=2^128-1.
+template <typename W>
+class RNG_t
 {
 public:
-    RNG(uint64_t N, uint64_t K);
-    RNG(uint64_t N, uint64_t K, StrategyType s);
-    RNG(uint64_t N, uint64_t K, StrategyType s, uint64_t seed); // <--- Previlegiate this constructor
-    uint64_t it();
+    RNG_t(W N, W K);
+    RNG_t(W N, W K, StrategyType s);
+    RNG_t(W N, W K, StrategyType s, uint64_t seed); // <--- Previlegiate this constructor
+    // AUTO with a quality floor (see AutoQuality() in Auto_rng.h) and a memory budget in bytes
+    RNG_t(W N, W K, StrategyType s, uint64_t seed, uint64_t min_quality, uint64_t memory_budget);
+    W it();
+    void fill(W *out, uint64_t n); // n calls to it(), written in out
+    void fill(uint32_t *out, uint64_t n); // The same in 32-bit words, for N < 2^32
+    void fill(uint16_t *out, uint64_t n); // The same in 16-bit words, for N < 2^16
+    void skip(W n);                // Discards the n next values
+    // dst[j] = src[it()] for the K+1 records of dst, src holds the N+1 records of the domain.
+    // The reads are grouped by source address and prefetched, the gathers of a chunk may be split on threads.
+    template <typename T>
+    void apply_permutation(const T *src, uint64_t src_size, T *dst, uint64_t dst_size, uint64_t threads = 1);
+    // apply_permutation() back into data, for K = N = size-1. It goes through a full copy of data:
+    // the peak memory is twice the array.
+    template <typename T>
+    void shuffle(T *data, uint64_t size, uint64_t threads = 1);
+    void reseed(uint64_t seed);          // Same sequence as RNG_t(N, K, s, seed), reusing the generator storage
+    void reset(W N, W K, uint64_t seed); // Same sequence as RNG_t(N, K, s, seed), reusing the generator storage
     void debug64(uint64_t x);
     uint64_t rand64();
-    ~RNG();
+    ~RNG_t();
 
-    Strategy *getStrategy();
-    uint64_t getNumSamples();
-    uint64_t getMaxValue();
-    uint64_t getMinValue();
+    StrategyT<W> *getStrategy();
+    W getNumSamples();
+    W getMaxValue();
+    W getMinValue();
     const char *GetName();
 
 private:
-    Strategy *Build(StrategyType s);
-    Strategy *CreateStrategy(StrategyType s, uint64_t seed);
+    StrategyT<W> *Build(StrategyType s);
+    StrategyT<W> *CreateStrategy(StrategyType s, uint64_t seed);
 
-    uint64_t N; // Values goes from [0,N], thus the number of values up to N+1
-    uint64_t K; // We generate K+1 samples
-    Strategy *strategy;
+    W N; // Values goes from [0,N], thus the number of values up to N+1
+    W K; // We generate K+1 samples
+    uint64_t auto_quality = 4;           // SUPER4 quality
+    uint64_t auto_budget = 64ull << 20; // 64 MB
+    StrategyT<W> *strategy;
 };
 
+typedef RNG_t<uint64_t> RNG;
+typedef RNG_t<uint128_t> RNG128;
+
+#include "Shuffle.h"
@@ -0,0 +1,103 @@
+#include <iostream>
+#include <algorithm>
+
+#include "RandomSplit.h"
+
+using namespace std;
+
+static const uint64_t MAX_N = 0xFFFFFFFFFFFFFFFEull; // N+1 positions are counted on 64 bits
+
+RandomSplit::RandomSplit(uint64_t N, const vector<uint64_t> &sizes, StrategyType st, uint64_t seed) : N(N)
+{
+    if (this->N > MAX_N)
+    {
+        std::cerr << "ERROR: N must be lower than 2^64-1, 2^64-2 is used" << std::endl;
+        this->N = MAX_N;
+    }
+    const uint64_t total = this->N + 1;
+
+    // Prefix sums of the sizes, cut at N+1
+    bool exact = !sizes.empty();
+    starts.push_back(0);
+    for (uint64_t size : sizes)
+    {
+        exact &= size <= total - starts.back();
+        starts.push_back(starts.back() + std::min(size, total - starts.back()));
+    }
+    if (sizes.empty())
+        starts.push_back(total);
+    if (!exact || starts.back() != total)
+    {
+        std::cerr << "ERROR: the sizes must sum to N+1, the last partition ends at N" << std::endl;
+        starts.back() = total;
+    }
+
+    // The permutation of the full pass: K = N gives the cycle walking mode, whose counter is the position
+    perm = new Super_rng(this->N, this->N, SuperLevel(st), seed, true);
+}
+
+RandomSplit::~RandomSplit() { delete perm; }
+
+uint64_t RandomSplit::walk(uint64_t x) const
+{
+    // As Super_rng::it() does with its counter
+    do
+    {
+        x = perm->permute(x);
+    } while (x > N);
+    return x;
+}
+
+uint64_t RandomSplit::walk_inv(uint64_t x) const
+{
+    // The cycle of x under permute() is walked backward, thus the first value in [0,N] is its position
+    do
+    {
+        x = perm->unpermute(x);
+    } while (x > N);
+    return x;
+}
+
+uint64_t RandomSplit::position(uint64_t x) const
+{
+    return walk_inv(x);
+}
+
+uint64_t RandomSplit::partition(uint64_t x) const
+{
+    // Few partitions, a linear search is faster than a binary one
+    uint64_t pos = walk_inv(x);
+    uint64_t p = 0;
+    while (starts[p + 1] <= pos)
+        p++;
+    return p;
+}
+
+uint64_t RandomSplit::member(uint64_t p, uint64_t j) const
+{
+    return walk(starts[p] + j);
+}
+
+void RandomSplit::fill(uint64_t p, uint64_t j, uint64_t *out, uint64_t n) const
+{
+    for (uint64_t t = 0; t < n; t++)
+        out[t] = walk(starts[p] + j + t);
+}
+
+uint64_t RandomSplit::next_sorted(uint64_t p, uint64_t x) const
+{
+    const uint64_t first = starts[p], last = starts[p + 1];
+    for (; x <= N; x++)
+    {
+        uint64_t pos = walk_inv(x);
+        if (pos >= first && pos < last)
+            return x;
+    }
+    return N + 1;
+}
+
+uint64_t RandomSplit::getNumPartitions() const { return starts.size() - 1; }
+uint64_t RandomSplit::getSize(uint64_t p) const { return starts[p + 1] - starts[p]; }
+uint64_t RandomSplit::getStart(uint64_t p) const { return starts[p]; }
+uint64_t RandomSplit::getMaxValue() const { return N; }
+const char *RandomSplit::GetName() const { return "Split"; }
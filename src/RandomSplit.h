@@ -0,0 +1,43 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+#include "RNG.h"
+#include "Super_rng.h"
+
+using namespace std;
+
+// Disjoint random partitions of [0,N] with given sizes (e.g. train/validation/test), without any list.
+// The partitions are consecutive ranges of positions in the permutation of Super_rng(N, N, level, seed, true):
+// partition p holds the values given at the positions [start(p), start(p)+size(p)[ of its it() series.
+// The j-th member of p is the permutation at start(p)+j, and the partition of x is found from the
+// inverse permutation (unpermute()), both in O(1). The members of p are streamed in increasing order
+// by testing the values of [0,N] one after the other, about (N+1)/size(p) tests per member.
+// All the methods are const: processes with the same (N, sizes, strategy, seed) agree without communicating.
+class RandomSplit
+{
+public:
+    RandomSplit(uint64_t N, const vector<uint64_t> &sizes, StrategyType s, uint64_t seed); // Sizes sum to N+1
+    ~RandomSplit();
+
+    uint64_t partition(uint64_t x) const;                // Partition of x in [0,N]
+    uint64_t position(uint64_t x) const;                 // Position of x in the permutation
+    uint64_t member(uint64_t p, uint64_t j) const;       // j-th member of p in permutation order, j < size(p)
+    void fill(uint64_t p, uint64_t j, uint64_t *out, uint64_t n) const; // Members j to j+n-1 of p
+    uint64_t next_sorted(uint64_t p, uint64_t x) const; // Smallest member of p >= x, N+1 if there is none
+
+    uint64_t getNumPartitions() const;
+    uint64_t getSize(uint64_t p) const;
+    uint64_t getStart(uint64_t p) const;
+    uint64_t getMaxValue() const;
+    const char *GetName() const;
+
+private:
+    uint64_t N;
+    vector<uint64_t> starts; // starts[p] is the first position of p, starts.back() = N+1
+    Super_rng *perm;
+
+    uint64_t walk(uint64_t x) const;     // Cycle walking of permute() into [0,N]
+    uint64_t walk_inv(uint64_t x) const; // Cycle walking of unpermute() into [0,N]
+};
@@ -0,0 +1,243 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <new>
+
+#include "SharedRNG.h"
+
+using namespace std;
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "the counter is shared by processes");
+
+// Layout of the shared memory segment. The counter has its own cache line, the rest is written once.
+struct SharedRNG::Segment
+{
+    uint64_t magic;
+    uint64_t N;
+    uint64_t K;
+    uint64_t level;
+    uint64_t seed;
+    uint64_t fingerprint; // Of the key schedule, see build()
+    std::atomic<uint64_t> ready; // Set by the creator once the fields above are written
+    alignas(64) std::atomic<uint64_t> next; // Next index to claim, may go beyond K
+};
+
+static const uint64_t SEGMENT_MAGIC = 0x474E524D48535752ull; // "RWSHMRNG"
+static const uint64_t MAX_CLAIM = 1ull << 32; // Claims are cut, thus next can not wrap before K+1 claims
+static const int ATTACH_TRIES = 1000; // 1 ms apart, while the creator sets the segment up
+
+SharedRNG::SharedRNG(const std::string &name, uint64_t N, uint64_t K, StrategyType s, uint64_t seed,
+                     uint64_t batch_size)
+    : name(name), batch_size(std::max(batch_size, (uint64_t)1))
+{
+    if (K > N)
+    {
+        std::cerr << "ERROR: K must be lower or equal to N, N is used" << std::endl;
+        K = N;
+    }
+    uint64_t level = SuperLevel(s);
+
+    fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+    if (fd < 0 && errno == EEXIST)
+    {
+        // Another process created it first: the same permutation is expected
+        fd = shm_open(name.c_str(), O_RDWR | O_CLOEXEC, 0);
+        if (!map(false) || !build())
+            return;
+        if (segment->N != N || segment->K != K || segment->level != level || segment->seed != seed)
+        {
+            std::cerr << "ERROR: the segment " << name << " holds another sequence (N: " << segment->N
+                      << " K: " << segment->K << " seed: " << segment->seed << ")" << std::endl;
+            delete strategy;
+            strategy = nullptr;
+        }
+        return;
+    }
+    if (fd < 0 || ftruncate(fd, sizeof(Segment)) != 0 || !map(true))
+    {
+        std::cerr << "ERROR: cannot create the segment " << name << ": " << strerror(errno) << std::endl;
+        return;
+    }
+    segment->magic = SEGMENT_MAGIC;
+    segment->N = N;
+    segment->K = K;
+    segment->level = level;
+    segment->seed = seed;
+    segment->fingerprint = 0;
+    if (!build())
+        return;
+    segment->ready.store(1, std::memory_order_release);
+}
+
+SharedRNG::SharedRNG(const std::string &name, uint64_t batch_size)
+    : name(name), batch_size(std::max(batch_size, (uint64_t)1))
+{
+    fd = shm_open(name.c_str(), O_RDWR | O_CLOEXEC, 0);
+    if (map(false))
+        build();
+}
+
+SharedRNG::~SharedRNG()
+{
+    delete strategy;
+    if (segment != nullptr)
+        munmap(segment, sizeof(Segment));
+    if (fd >= 0)
+        close(fd);
+}
+
+bool SharedRNG::remove(const std::string &name)
+{
+    return shm_unlink(name.c_str()) == 0;
+}
+
+bool SharedRNG::map(bool created)
+{
+    if (fd < 0)
+    {
+        std::cerr << "ERROR: cannot open the segment " << name << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+    // The creator may not have sized the segment yet
+    struct stat st;
+    for (int t = 0; !created && (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(Segment)); t++)
+    {
+        if (t == ATTACH_TRIES)
+        {
+            std::cerr << "ERROR: the segment " << name << " is not a SharedRNG" << std::endl;
+            return false;
+        }
+        usleep(1000);
+    }
+
+    void *p = mmap(nullptr, sizeof(Segment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED)
+    {
+        std::cerr << "ERROR: cannot map the segment " << name << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+    if (created)
+    {
+        segment = new (p) Segment();
+        return true;
+    }
+    segment = (Segment *)p;
+    for (int t = 0; segment->ready.load(std::memory_order_acquire) == 0; t++)
+    {
+        if (t == ATTACH_TRIES)
+        {
+            std::cerr << "ERROR: the segment " << name << " is not a SharedRNG" << std::endl;
+            munmap(segment, sizeof(Segment));
+            segment = nullptr;
+            return false;
+        }
+        usleep(1000);
+    }
+    if (segment->magic != SEGMENT_MAGIC)
+    {
+        std::cerr << "ERROR: the segment " << name << " is not a SharedRNG" << std::endl;
+        munmap(segment, sizeof(Segment));
+        segment = nullptr;
+        return false;
+    }
+    return true;
+}
+
+bool SharedRNG::build()
+{
+    // The key schedule is a function of (N, level, seed): each process derives its own copy, and the
+    // permutation of a few values tells whether it is the one of the creator (another build, or a segment
+    // written by another version of the library).
+    strategy = new Super_rng(segment->N, segment->N, segment->level, segment->seed, true);
+    origin = strategy->getI();
+    uint64_t fingerprint = segment->N ^ segment->level;
+    for (uint64_t x = 0; x < 8; x++)
+        fingerprint = Strategy::splitmix64(fingerprint ^ strategy->permute(x));
+    fingerprint |= 1; // 0 while the creator builds it
+
+    if (segment->fingerprint == 0)
+        segment->fingerprint = fingerprint;
+    else if (segment->fingerprint != fingerprint)
+    {
+        std::cerr << "ERROR: the segment " << name << " was created with another key schedule" << std::endl;
+        delete strategy;
+        strategy = nullptr;
+        return false;
+    }
+    return true;
+}
+
+bool SharedRNG::ok() const
+{
+    return strategy != nullptr;
+}
+
+uint64_t SharedRNG::claim(uint64_t n, uint64_t &first)
+{
+    if (!ok() || n == 0)
+        return 0;
+    // One atomic add, whatever the number of processes. Once exhausted the counter is only read, thus it
+    // goes beyond K+1 by the racing claims only.
+    if (segment->next.load(std::memory_order_relaxed) > segment->K)
+        return 0;
+    n = std::min(n, MAX_CLAIM);
+    first = segment->next.fetch_add(n, std::memory_order_relaxed);
+    if (first > segment->K)
+        return 0;
+    return std::min(n - 1, segment->K - first) + 1;
+}
+
+void SharedRNG::values(uint64_t first, uint64_t *out, uint64_t n)
+{
+    // The cycle walking mode of Super_rng computes the values from the counter alone
+    strategy->restore(origin + first, strategy->getDraws());
+    strategy->fill(out, n);
+}
+
+uint64_t SharedRNG::fill(uint64_t *out, uint64_t n)
+{
+    uint64_t first;
+    uint64_t count = claim(n, first);
+    if (count > 0)
+        values(first, out, count);
+    return count;
+}
+
+bool SharedRNG::next(uint64_t &value)
+{
+    if (position == batch.size())
+    {
+        batch.resize(batch_size);
+        batch.resize(fill(batch.data(), batch_size));
+        position = 0;
+        if (batch.empty())
+            return false;
+    }
+    value = batch[position++];
+    return true;
+}
+
+uint64_t SharedRNG::at(uint64_t index) const
+{
+    uint64_t x = strategy->permute(origin + index);
+    while (x > segment->N)
+        x = strategy->permute(x);
+    return x;
+}
+
+uint64_t SharedRNG::getClaimed() const
+{
+    uint64_t next = segment->next.load(std::memory_order_relaxed);
+    return (next > segment->K) ? segment->K + 1 : next;
+}
+
+uint64_t SharedRNG::getNumSamples() const { return segment->K + 1; }
+uint64_t SharedRNG::getMaxValue() const { return segment->N; }
+const char *SharedRNG::GetName() const { return strategy->GetName(); }
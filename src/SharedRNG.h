@@ -0,0 +1,55 @@
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "RNG.h"
+#include "Super_rng.h"
+
+// The K+1 first values of Super_rng(N, N, level, seed, true) shared by the processes of a host through a
+// POSIX shared memory segment (shm_open). They are the values of RNG(N, N, s, seed) with SUPER5 or beyond
+// 2^32 values, where RNG walks too. The segment holds the parameters of the permutation and the counter of the next index:
+// a process claims a range of indices with one atomic add and evaluates their values with its own copy of
+// the key schedule, thus values are never computed twice nor sent between processes.
+// A range claimed by a process which dies before using it is skipped, no other process gets its values.
+// Only the SUPERx strategies are understood, the others are replaced by SUPER1.
+class SharedRNG
+{
+public:
+    // Creates the segment name ("/name"), or attaches to it if it exists with the same N, K, s and seed.
+    // next() takes the values from claims of batch_size indices.
+    SharedRNG(const std::string &name, uint64_t N, uint64_t K, StrategyType s, uint64_t seed,
+              uint64_t batch_size = 1024);
+    SharedRNG(const std::string &name, uint64_t batch_size = 1024); // Attaches to an existing segment
+    ~SharedRNG(); // Unmaps the segment, which stays until remove()
+    static bool remove(const std::string &name);
+
+    bool ok() const; // Attached, to a segment of the same permutation
+    uint64_t claim(uint64_t n, uint64_t &first);          // Reserves [first, first+count[, returns count, 0 once exhausted
+    void values(uint64_t first, uint64_t *out, uint64_t n); // Values of the indices [first, first+n[
+    uint64_t fill(uint64_t *out, uint64_t n);             // claim() then values(), returns the count
+    bool next(uint64_t &value);                           // false once exhausted
+    uint64_t at(uint64_t index) const;                    // Value of one index, in [0,N]
+
+    uint64_t getClaimed() const;    // Indices claimed by all the processes, at most K+1
+    uint64_t getNumSamples() const; // K+1
+    uint64_t getMaxValue() const;   // N
+    const char *GetName() const;
+
+private:
+    struct Segment;
+
+    std::string name;
+    int fd = -1;
+    Segment *segment = nullptr;
+    Super_rng *strategy = nullptr;
+    uint64_t origin; // Counter of the index 0, random for N=2^64-1
+
+    uint64_t batch_size;
+    std::vector<uint64_t> batch;
+    size_t position = 0;
+
+    bool map(bool created);
+    bool build(); // Key schedule of the segment parameters, checked against its fingerprint
+};
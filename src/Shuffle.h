@@ -0,0 +1,174 @@
+#pragma once
+
+// Definitions of the RNG_t::shuffle() and RNG_t::apply_permutation() member templates, included by RNG.h
+
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <type_traits>
+
+// Output j of the generator is the index of the record gathered in dst[j]. A naive gather misses the
+// cache and the TLB on almost every record once src is larger than the cache. Instead, the indices
+// are drawn by chunks whose destination fits in the cache, and each chunk is radix-partitioned by
+// source address (counting sort on the high bits of the index). The gather then reads src in
+// increasing address order, with software prefetch, and writes in a cache-resident part of dst.
+template <typename W>
+template <typename T>
+void RNG_t<W>::apply_permutation(const T *src, uint64_t src_size, T *dst, uint64_t dst_size, uint64_t threads)
+{
+    if (src_size == 0 || (W)src_size - 1 != N || (W)dst_size != getNumSamples())
+    {
+        std::cerr << "ERROR: apply_permutation needs N+1 source records and K+1 destination records" << std::endl;
+        return;
+    }
+    if (threads == 0)
+        threads = 1;
+
+    const uint64_t PREFETCH_DISTANCE = 16;
+    const uint64_t RADIX_BITS = 12;
+    const uint64_t chunk = std::min(dst_size, std::max((uint64_t)1 << 16, ((uint64_t)1 << 22) / sizeof(T)));
+    const uint64_t index_bits = StrategyT<uint64_t>::bit_width(src_size - 1);
+    const uint64_t shift = index_bits > RADIX_BITS ? index_bits - RADIX_BITS : 0;
+    const uint64_t buckets = ((src_size - 1) >> shift) + 1;
+
+    // A source smaller than the cache needs no partitioning
+    const bool partition = src_size * sizeof(T) > ((uint64_t)1 << 22);
+
+    std::vector<uint64_t> index(chunk), sorted_index(partition ? chunk : 0);
+    std::vector<W> drawn(std::is_same<W, uint64_t>::value ? 0 : chunk);
+    std::vector<uint32_t> sorted_pos(partition ? chunk : 0);
+    std::vector<uint64_t> count(partition ? buckets + 1 : 0);
+    uint64_t c = 0;
+    T *out = dst;
+
+    // The chunk positions are disjoint, thus the threads write without synchronization
+    auto gather = [&](uint64_t begin, uint64_t end)
+    {
+        for (uint64_t s = begin; s < end; s++)
+        {
+            if (s + PREFETCH_DISTANCE < end)
+                __builtin_prefetch(src + sorted_index[s + PREFETCH_DISTANCE]);
+            out[sorted_pos[s]] = src[sorted_index[s]];
+        }
+    };
+
+    // The workers are created once per call. For each chunk the calling thread draws and partitions,
+    // then a new round hands a share of the gather to every worker, and it gathers the first share.
+    std::mutex mutex;
+    std::condition_variable ready, done;
+    uint64_t round = 0, pending = 0;
+    bool stop = false;
+    std::vector<std::thread> workers;
+    if (partition)
+    {
+        for (uint64_t w = 1; w < threads; w++)
+        {
+            workers.emplace_back(
+                [&, w]()
+                {
+                    uint64_t seen = 0;
+                    while (true)
+                    {
+                        uint64_t begin, end;
+                        {
+                            std::unique_lock<std::mutex> lock(mutex);
+                            ready.wait(lock, [&]() { return stop || round != seen; });
+                            if (stop)
+                                return;
+                            seen = round;
+                            begin = c * w / threads;
+                            end = c * (w + 1) / threads;
+                        }
+                        gather(begin, end);
+                        std::lock_guard<std::mutex> lock(mutex);
+                        if (--pending == 0)
+                            done.notify_one();
+                    }
+                });
+        }
+    }
+
+    for (uint64_t base = 0; base < dst_size; base += chunk)
+    {
+        c = std::min(chunk, dst_size - base);
+        if constexpr (std::is_same<W, uint64_t>::value)
+        {
+            fill(index.data(), c);
+        }
+        else
+        {
+            fill(drawn.data(), c);
+            for (uint64_t t = 0; t < c; t++)
+                index[t] = (uint64_t)drawn[t];
+        }
+        out = dst + base;
+
+        if (!partition)
+        {
+            for (uint64_t t = 0; t < c; t++)
+            {
+                if (t + PREFETCH_DISTANCE < c)
+                    __builtin_prefetch(src + index[t + PREFETCH_DISTANCE]);
+                out[t] = src[index[t]];
+            }
+            continue;
+        }
+
+        std::fill(count.begin(), count.end(), 0);
+        for (uint64_t t = 0; t < c; t++)
+            count[(index[t] >> shift) + 1]++;
+        for (uint64_t b = 0; b < buckets; b++)
+            count[b + 1] += count[b];
+        for (uint64_t t = 0; t < c; t++)
+        {
+            uint64_t slot = count[index[t] >> shift]++;
+            sorted_index[slot] = index[t];
+            sorted_pos[slot] = (uint32_t)t;
+        }
+
+        if (workers.empty())
+        {
+            gather(0, c);
+            continue;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            round++;
+            pending = workers.size();
+        }
+        ready.notify_all();
+        gather(0, c / threads);
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [&]() { return pending == 0; });
+    }
+
+    if (!workers.empty())
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stop = true;
+        }
+        ready.notify_all();
+        for (std::thread &worker : workers)
+            worker.join();
+    }
+}
+
+// The permutation is applied through a copy of the records, the generator must have K = N = size-1.
+// Thus the peak memory is twice the array. Following the cycles in place would need the inverse of
+// the permutation, or random access to it, and gives up the address-ordered gather.
+template <typename W>
+template <typename T>
+void RNG_t<W>::shuffle(T *data, uint64_t size, uint64_t threads)
+{
+    if (size == 0 || (W)size - 1 != N || K != N)
+    {
+        std::cerr << "ERROR: shuffle needs K = N = size-1" << std::endl;
+        return;
+    }
+    std::vector<T> copy(data, data + size);
+    apply_permutation(copy.data(), size, data, size, threads);
+}
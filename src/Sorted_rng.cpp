@@ -0,0 +1,166 @@
+#include <math.h>
+#include <algorithm>
+
+#include "Sorted_rng.h"
+
+using namespace std;
+
+template <typename W>
+Sorted_rng_t<W>::Sorted_rng_t(W N, W K, uint64_t seed) : StrategyT<W>(N, K, seed)
+{
+    init_selection();
+}
+
+template <typename W>
+Sorted_rng_t<W>::Sorted_rng_t(W N, W K) : StrategyT<W>(N, K)
+{
+    init_selection();
+}
+
+template <typename W>
+void Sorted_rng_t<W>::init_selection()
+{
+    population = modulus; // with N=MAX_WORD the modulus is MAX_WORD: the last value is left out
+    remaining = std::min(nb_samples, population);
+    current = 0;
+    i = 0;
+    method_a = (double)remaining * alpha_inv >= (double)population;
+    Vprime = exp(log(uniform()) / (double)remaining);
+}
+
+template <typename W>
+void Sorted_rng_t<W>::reseed(uint64_t seed)
+{
+    StrategyT<W>::reseed(seed);
+    init_selection();
+}
+
+template <typename W>
+void Sorted_rng_t<W>::reset(W N, W K, uint64_t seed)
+{
+    StrategyT<W>::reset(N, K, seed);
+    init_selection();
+}
+
+template <typename W>
+double Sorted_rng_t<W>::uniform()
+{
+    return ((double)(StrategyT<W>::rand64() >> 11) + 0.5) * (1. / 9007199254740992.); // 53 bits
+}
+
+template <typename W>
+W Sorted_rng_t<W>::skip_D()
+{
+    const double n = (double)remaining;
+    const double N = (double)population;
+    const double ninv = 1. / n;
+    const double nmin1inv = 1. / (n - 1.);
+    const double qu1 = N - n + 1.;
+    double X, S;
+
+    while (true)
+    {
+        // Step D2: generate U and X
+        while (true)
+        {
+            X = N * (1. - Vprime);
+            S = floor(X);
+            if (S < qu1)
+                break;
+            Vprime = exp(log(uniform()) * ninv);
+        }
+        double U = uniform();
+
+        // Step D3: accept?
+        double y1 = exp(log(U * N / qu1) * nmin1inv);
+        Vprime = y1 * (1. - X / N) * (qu1 / (qu1 - S));
+        if (Vprime <= 1.)
+            break; // Vprime is kept for the next gap
+
+        // Step D4: accept? The loop is O(min(S,n)) but rarely reached
+        double y2 = 1., top = N - 1., bottom, limit;
+        if (n - 1. > S)
+        {
+            bottom = N - n;
+            limit = N - S;
+        }
+        else
+        {
+            bottom = N - S - 1.;
+            limit = qu1;
+        }
+        for (double t = N - 1.; t >= limit; t--)
+        {
+            y2 = (y2 * top) / bottom;
+            top--;
+            bottom--;
+        }
+        if (N / (N - X) >= y1 * exp(log(y2) * nmin1inv))
+        {
+            Vprime = exp(log(uniform()) * nmin1inv);
+            break;
+        }
+        Vprime = exp(log(uniform()) * ninv);
+    }
+    return (W)S;
+}
+
+template <typename W>
+W Sorted_rng_t<W>::skip_A()
+{
+    double top = (double)(population - remaining);
+    double N = (double)population;
+    double V = uniform();
+    double quot = top / N;
+    W S = 0;
+    while (quot > V)
+    {
+        S++;
+        top--;
+        N--;
+        quot = (quot * top) / N;
+    }
+    return S;
+}
+
+template <typename W>
+W Sorted_rng_t<W>::it()
+{
+    if (remaining == 0)
+    {
+        // A new sorted sample: like the other strategies, values may repeat after the K+1 first ones
+        init_selection();
+    }
+
+    W S;
+    if (remaining == 1)
+    {
+        double X = (double)population * (method_a ? uniform() : Vprime);
+        S = (X < (double)population) ? (W)X : population - 1;
+    }
+    else
+    {
+        if (!method_a && (double)remaining * alpha_inv >= (double)population)
+            method_a = true;
+        S = method_a ? skip_A() : skip_D();
+    }
+
+    // Rounding of the doubles must never leave less values than the ones still to select
+    S = std::min(S, population - remaining);
+
+    W out = current + S;
+    current = out + 1;
+    population -= S + 1;
+    remaining--;
+    i++;
+    return out;
+}
+
+template <typename W>
+const char *Sorted_rng_t<W>::GetName() const
+{
+    return "Sorted";
+}
+
+template class Sorted_rng_t<uint64_t>;
+template class Sorted_rng_t<uint128_t>;
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <stdint.h>
+#include "Strategy.h"
+
+// K+1 distinct values of [0,N] in increasing order, with O(1) memory.
+// Sequential sampling of Vitter (Method D, "An efficient algorithm for sequential random sampling",
+// ACM TOMS 1987): each call draws the gap to the next selected value in constant expected time.
+// Method A takes over when the remaining sample is dense (n >= N/13), its gaps are then short.
+// With N=2^64-1 the population is [0,2^64-2]: the number of values must fit in a word.
+template <typename W>
+class Sorted_rng_t : public StrategyT<W>
+{
+public:
+    Sorted_rng_t(W N, W K, uint64_t seed);
+    Sorted_rng_t(W N, W K);
+    W it();
+    void reseed(uint64_t seed);
+    void reset(W N, W K, uint64_t seed);
+    const char *GetName() const;
+
+private:
+    using StrategyT<W>::modulus;
+    using StrategyT<W>::nb_samples;
+    using StrategyT<W>::i;
+
+    void init_selection();
+    double uniform(); // In ]0,1[
+    W skip_D();
+    W skip_A();
+
+    W population; // Values not yet passed over
+    W remaining;  // Values still to select, "n" in Vitter's paper
+    W current;    // Smallest value not yet passed over
+    double Vprime;
+    bool method_a;
+    const double alpha_inv = 13.; // Method A when remaining >= population / alpha_inv
+};
+
+typedef Sorted_rng_t<uint64_t> Sorted_rng;
@@ -0,0 +1,73 @@
+#include <algorithm>
+
+#include "Sparse_rng.h"
+
+using namespace std;
+
+template <typename W>
+size_t Sparse_rng_t<W>::Hash::operator()(W x) const
+{
+    return StrategyT<W>::splitmix64((uint64_t)x ^ StrategyT<W>::splitmix64((uint64_t)((x >> 32) >> 32)));
+}
+
+template <typename W>
+Sparse_rng_t<W>::Sparse_rng_t(W N, W K, uint64_t seed) : StrategyT<W>(N, K, seed)
+{
+    init_map();
+}
+
+template <typename W>
+void Sparse_rng_t<W>::init_map()
+{
+    moved.clear();
+    moved.reserve((size_t)std::min(nb_samples, (W)(1ull << 24)));
+    i = 0;
+}
+
+template <typename W>
+void Sparse_rng_t<W>::reseed(uint64_t seed)
+{
+    StrategyT<W>::reseed(seed);
+    init_map();
+}
+
+template <typename W>
+void Sparse_rng_t<W>::reset(W N, W K, uint64_t seed)
+{
+    StrategyT<W>::reset(N, K, seed);
+    init_map();
+}
+
+template <typename W>
+W Sparse_rng_t<W>::it()
+{
+    // Swap of the positions j and t, then j is never read again: its entry is removed
+    if (i > N) // New pass
+        init_map();
+    W j = i++;
+    W t = j + StrategyT<W>::randUpTo(N - j);
+    auto at_j = moved.find(j);
+    W vj = (at_j == moved.end()) ? j : at_j->second;
+    if (at_j != moved.end())
+        moved.erase(at_j);
+    if (t == j)
+        return vj;
+    auto at_t = moved.find(t);
+    if (at_t == moved.end())
+    {
+        moved.emplace(t, vj);
+        return t;
+    }
+    W vt = at_t->second;
+    at_t->second = vj;
+    return vt;
+}
+
+template <typename W>
+const char *Sparse_rng_t<W>::GetName() const
+{
+    return "Sparse";
+}
+
+template class Sparse_rng_t<uint64_t>;
+template class Sparse_rng_t<uint128_t>;
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <stdint.h>
+#include <unordered_map>
+#include "Strategy.h"
+
+// K+1 values of a random permutation of [0,N], for K much smaller than N.
+// Fisher-Yates on a virtual table: a hash map holds only the positions moved by the swaps, the
+// others hold their own index. Each value costs one swap, the map holds at most K+1 entries and the
+// sample is exactly uniform, whatever N.
+template <typename W>
+class Sparse_rng_t : public StrategyT<W>
+{
+public:
+    Sparse_rng_t(W N, W K, uint64_t seed);
+    W it();
+    void reseed(uint64_t seed);
+    void reset(W N, W K, uint64_t seed);
+    const char *GetName() const;
+
+private:
+    using StrategyT<W>::N;
+    using StrategyT<W>::i;
+    using StrategyT<W>::nb_samples;
+
+    struct Hash
+    {
+        size_t operator()(W x) const;
+    };
+    std::unordered_map<W, W, Hash> moved; // Position -> value, for the positions not holding their index
+    void init_map();
+};
+
+typedef Sparse_rng_t<uint64_t> Sparse_rng;
@@ -1,70 +1,197 @@
+
 #include <type_traits>
 #include <cstdint>
 #include <random>
 #include <iostream>
 #include <bitset>
+#include <algorithm>
+#include <sstream>
 
 #include "Strategy.h"
 
 using namespace std;
 
-Strategy::Strategy(uint64_t N, uint64_t K, uint64_t seed) : N(N), K(K)
+template <typename W>
+StrategyT<W>::StrategyT(W N, W K, uint64_t seed) : N(N), K(K)
 {
     init_deterministic();
     init_rng(seed);
     init_i();
 }
 
-Strategy::Strategy(uint64_t N, uint64_t K) : N(N), K(K)
+template <typename W>
+StrategyT<W>::StrategyT(W N, W K) : N(N), K(K)
 {
     init_deterministic();
     init_rng();
     init_i();
 }
 
-void Strategy::init_deterministic()
+template <typename W>
+void StrategyT<W>::reseed(uint64_t seed)
+{
+    init_rng(seed);
+    init_i();
+}
+
+template <typename W>
+void StrategyT<W>::reset(W N, W K, uint64_t seed)
+{
+    this->N = N;
+    this->K = K;
+    init_deterministic();
+    init_rng(seed);
+    init_i();
+}
+
+template <typename W>
+bool StrategyT<W>::skip(W)
+{
+    return false;
+}
+
+template <typename W>
+void StrategyT<W>::fill(W *out, uint64_t n)
+{
+    for (uint64_t j = 0; j < n; j++)
+    {
+        W v;
+        do
+        {
+            v = it();
+        } while (v > N);
+        out[j] = v;
+    }
+}
+
+template <typename W>
+template <typename T>
+void StrategyT<W>::fill_narrowed(T *out, uint64_t n)
+{
+    W chunk[256];
+    for (uint64_t j = 0; j < n; j += 256)
+    {
+        const uint64_t c = std::min((uint64_t)256, n - j);
+        fill(chunk, c);
+        for (uint64_t t = 0; t < c; t++)
+            out[j + t] = (T)chunk[t];
+    }
+}
+
+template <typename W>
+void StrategyT<W>::fill(uint32_t *out, uint64_t n)
+{
+    fill_narrowed(out, n);
+}
+
+template <typename W>
+void StrategyT<W>::fill(uint16_t *out, uint64_t n)
+{
+    fill_narrowed(out, n);
+}
+
+template <typename W>
+void StrategyT<W>::restore(W i, uint64_t draws)
 {
-    if (N == MAX_UINT64)
+    if (draws < this->draws)
     {
-        modulus = static_cast<uint64_t>(N); // avoid arithmetic error
+        init_rng(seed);
+    }
+    rng.discard(draws - this->draws);
+    this->draws = draws;
+    this->i = i;
+}
+
+template <typename W>
+uint64_t StrategyT<W>::getRngState(uint64_t *words)
+{
+    // The text form is the only portable access to the engine: 312 words, the index follows in libstdc++.
+    // It costs tens of microseconds, thus it is kept until the next rand64().
+    if (rng_state_draws != draws)
+    {
+        std::ostringstream text;
+        text << rng;
+        std::istringstream in(text.str());
+        rng_state.clear();
+        uint64_t w;
+        while (rng_state.size() < RNG_STATE_WORDS && in >> w)
+            rng_state.push_back(w);
+        rng_state_draws = draws;
+    }
+    std::copy(rng_state.begin(), rng_state.end(), words);
+    return rng_state.size();
+}
+
+template <typename W>
+bool StrategyT<W>::restore(W i, uint64_t draws, const uint64_t *rng_state, uint64_t words)
+{
+    if (words > RNG_STATE_WORDS)
+        return false;
+    std::ostringstream text;
+    for (uint64_t w = 0; w < words; w++)
+        text << rng_state[w] << ' ';
+    std::istringstream in(text.str());
+    std::mt19937_64 engine;
+    if (!(in >> engine))
+        return false;
+    rng = engine;
+    this->rng_state.assign(rng_state, rng_state + words);
+    rng_state_draws = draws;
+    this->draws = draws;
+    this->i = i;
+    return true;
+}
+
+template <typename W>
+void StrategyT<W>::init_deterministic()
+{
+    if (N == MAX_WORD)
+    {
+        modulus = N; // avoid arithmetic error
     }
     else
     {
-        modulus = static_cast<uint64_t>(N) + 1;
+        modulus = N + 1;
     }
-    if (K == MAX_UINT64)
+    if (K == MAX_WORD)
     {
-        nb_samples = static_cast<uint64_t>(K); // avoid arithmetic error
+        nb_samples = K; // avoid arithmetic error
     }
     else
     {
-        nb_samples = static_cast<uint64_t>(K) + 1;
+        nb_samples = K + 1;
     }
 
+    // Exact ceil(log2(modulus)). A double has not enough precision for large words.
     if (N == 0 or N == 1)
         num_bits = 1;
     else
-        num_bits = (uint64_t)std::ceil(std::log2(modulus));
+        num_bits = bit_width(modulus - 1);
 }
 
-void Strategy::init_rng(uint64_t seed)
+template <typename W>
+void StrategyT<W>::init_rng(uint64_t seed)
 {
-    rng = std::mt19937_64(seed);                       // initialize the random number engine with the given seed
-    distr = std::uniform_int_distribution<uint64_t>(); // define the distribution for uint64_t values
+    this->seed = seed;
+    draws = 0;
+    rng_state_draws = ~0ull; // No getRngState() of this seed yet
+    rng.seed(seed); // initialize the random number engine with the given seed, in place
+    distr.reset();  // the distribution for uint64_t values keeps no state
 }
 
-void Strategy::init_rng()
+template <typename W>
+void StrategyT<W>::init_rng()
 {
-    std::random_device rd;                             // obtain a random seed from the OS
-    rng = std::mt19937_64(rd());                       // initialize the random number engine with the seed
-    distr = std::uniform_int_distribution<uint64_t>(); // define the distribution for uint64_t values
+    std::random_device rd; // obtain a random seed from the OS
+    init_rng(rd());        // the seed is kept, thus the state can be saved
 }
 
-void Strategy::init_i()
+template <typename W>
+void StrategyT<W>::init_i()
 {
     if ((modulus - nb_samples) > 0)
     {
-        i = rand64() % (modulus - nb_samples); // Random initial position
+        i = randW() % (modulus - nb_samples); // Random initial position
     }
     else
     {
@@ -73,27 +200,90 @@ void Strategy::init_i()
 }
 
 // Generally usefull functions
-uint64_t Strategy::rand64()
+template <typename W>
+uint64_t StrategyT<W>::rand64()
 {
+    draws++;
     return distr(rng);
 }
 
-void Strategy::debug64(uint64_t x)
+template <typename W>
+W StrategyT<W>::randW()
+{
+    W x = rand64();
+    for (uint64_t lane = 1; lane < WORD_BITS / 64; lane++)
+    {
+        x = (x << 32) << 32; // two shifts: no warning when W is 64 bits
+        x |= rand64();
+    }
+    return x;
+}
+
+template <typename W>
+W StrategyT<W>::randUpTo(W max)
+{
+    const uint64_t bits = bit_width(max);
+    const W mask = (bits < WORD_BITS) ? ((W)1 << bits) - 1 : MAX_WORD;
+    W x;
+    do
+    {
+        x = ((bits <= 64) ? (W)rand64() : randW()) & mask;
+    } while (x > max); // Less than 2 draws on average
+    return x;
+}
+
+template <typename W>
+uint64_t StrategyT<W>::splitmix64(uint64_t x)
+{
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+template <typename W>
+uint64_t StrategyT<W>::bit_width(W x)
+{
+    if (WORD_BITS > 64)
+    {
+        uint64_t high = (uint64_t)((x >> 32) >> 32);
+        if (high != 0)
+            return 128 - __builtin_clzll(high);
+    }
+    uint64_t low = (uint64_t)x;
+    if (low == 0)
+        return 0;
+    return 64 - __builtin_clzll(low);
+}
+
+template <typename W>
+void StrategyT<W>::debug64(uint64_t x)
 {
     std::bitset<std::numeric_limits<uint64_t>::digits> bitx(x);
     std::cout << bitx << " : " << x << std::endl;
 }
 
-uint64_t Strategy::getNumSamples() { return nb_samples; }
-uint64_t Strategy::getMaxValue()
+template <typename W>
+W StrategyT<W>::getNumSamples() { return nb_samples; }
+template <typename W>
+W StrategyT<W>::getMaxValue()
 {
-    if (modulus < MAX_UINT64)
+    if (modulus < MAX_WORD)
         return modulus - 1;
     else
-        return MAX_UINT64;
+        return MAX_WORD;
 }
-uint64_t Strategy::getMinValue()
+template <typename W>
+W StrategyT<W>::getMinValue()
 {
-    return 0ull;
+    return 0;
 }
-uint64_t Strategy::getI() const { return i; }
+template <typename W>
+W StrategyT<W>::getI() const { return i; }
+template <typename W>
+uint64_t StrategyT<W>::getSeed() const { return seed; }
+template <typename W>
+uint64_t StrategyT<W>::getDraws() const { return draws; }
+
+template class StrategyT<uint64_t>;
+template class StrategyT<uint128_t>;
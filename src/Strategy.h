@@ -2,42 +2,77 @@
 
 #include <stdint.h>
 #include <random>
+#include <vector>
 
-class Strategy // Abstract class pure virtual
+// 128-bit words for UUID-sized domains
+typedef unsigned __int128 uint128_t;
+
+// W is the word type of the generated values: uint64_t or uint128_t.
+template <typename W>
+class StrategyT // Abstract class pure virtual
 {
 public:
-    Strategy(uint64_t N, uint64_t K, uint64_t seed);
-    Strategy(uint64_t N, uint64_t K);
-    virtual uint64_t it() = 0; // Pure Virtual
+    StrategyT(W N, W K, uint64_t seed);
+    StrategyT(W N, W K);
+    virtual ~StrategyT() {}
+    virtual W it() = 0; // Pure Virtual
+    virtual void reseed(uint64_t seed);          // Restarts with a new seed, N and K are kept
+    virtual void reset(W N, W K, uint64_t seed); // Restarts with a new domain and seed
+    virtual bool skip(W n);                      // Jumps n outputs of it() in O(1) if possible, returns false otherwise
+    virtual void fill(W *out, uint64_t n);       // n values of it() in [0,N], the out-of-range ones are skipped
+    virtual void fill(uint32_t *out, uint64_t n); // Same values in 32-bit words, for N < 2^32
+    virtual void fill(uint16_t *out, uint64_t n); // Same values in 16-bit words, for N < 2^16
     virtual const char *GetName() const = 0;
     void debug64(uint64_t x); // From number to its binary representation
     uint64_t rand64();
+    W randW(); // One rand64() per 64-bit lane
+    W randUpTo(W max); // Uniform in [0,max], by rejection on the bit_width(max) low bits of the draws
+    static uint64_t splitmix64(uint64_t x); // Stateless 64-bit mixer, used to derive seeds from (seed, stream) pairs
+    static uint64_t bit_width(W x);         // Number of bits needed to write x, 0 for x=0
 
-    uint64_t getNumSamples();
-    uint64_t getMaxValue();
-    uint64_t getMinValue();
-    uint64_t getI() const;
-    // Warning: Values goes from 0 inclusively and getModulus() exclusively if N<2**64-1, otherwise getModulus() is inclusive.
+    W getNumSamples();
+    W getMaxValue();
+    W getMinValue();
+    W getI() const;
+    uint64_t getSeed() const;
+    uint64_t getDraws() const; // Number of rand64() since the seeding
+    void restore(W i, uint64_t draws); // Restores a state saved with getI() and getDraws(), for the same seed
+    // The draws are replayed by restore(i, draws), O(draws). The state of the Mersenne Twister avoids them:
+    static const uint64_t RNG_STATE_WORDS = 320; // Bound on the words of getRngState()
+    uint64_t getRngState(uint64_t *words);        // Writes the state of rng, returns its number of words
+    bool restore(W i, uint64_t draws, const uint64_t *rng_state, uint64_t words); // O(1), false on invalid state
+    // Warning: Values goes from 0 inclusively and getModulus() exclusively if N<MAX_WORD, otherwise getModulus() is inclusive.
 protected:
     // Mersenne Twister 64-bit version to generate a random number with a high degree of randomness.
     std::mt19937_64 rng;
     std::uniform_int_distribution<uint64_t> distr;
+    uint64_t seed;
+    uint64_t draws;
 
-    uint64_t N;
-    uint64_t K;
+    W N;
+    W K;
 
-    uint64_t modulus;
-    uint64_t nb_samples;
+    W modulus;
+    W nb_samples;
 
     uint64_t num_bits;
-    uint64_t i;
+    W i;
+
+    static const uint64_t WORD_BITS = sizeof(W) * 8;
+    const W MAX_WORD = ~(W)0;
 
-    const uint64_t MAX_UINT64 = 0xFFFFFFFFFFFFFFFFull;
+    template <typename T>
+    void fill_narrowed(T *out, uint64_t n); // fill() by chunks of W words, stored as T
 
 private:
+    std::vector<uint64_t> rng_state; // Last getRngState(), valid while no rand64() is drawn
+    uint64_t rng_state_draws;
+
     void init_deterministic();
     void init_rng(uint64_t seed);
     void init_rng();
     void init_i();
 };
 
+typedef StrategyT<uint64_t> Strategy;
+typedef StrategyT<uint128_t> Strategy128;
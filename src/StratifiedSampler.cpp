@@ -0,0 +1,263 @@
+#include <iostream>
+#include <algorithm>
+
+#include "StratifiedSampler.h"
+
+using namespace std;
+
+static const uint64_t MAX_N = 0xFFFFFFFFFFFFFFFEull; // N+1 values are counted on 64 bits
+
+StratifiedSampler::StratifiedSampler(uint64_t N, const vector<uint64_t> &sizes, const vector<uint64_t> &quotas,
+                                     uint64_t seed)
+    : N(N)
+{
+    if (this->N > MAX_N)
+    {
+        std::cerr << "ERROR: N must be lower than 2^64-1, 2^64-2 is used" << std::endl;
+        this->N = MAX_N;
+    }
+    const uint64_t total = this->N + 1;
+
+    // Consecutive strata, cut at N+1, as the partitions of RandomSplit
+    bool exact = !sizes.empty();
+    uint64_t start = 0;
+    for (uint64_t size : sizes)
+    {
+        exact &= size <= total - start;
+        size = std::min(size, total - start);
+        strata.push_back({start, size, 0, 0, 0, 0});
+        start += size;
+    }
+    if (sizes.empty())
+        strata.push_back({0, 0, 0, 0, 0, 0});
+    if (!exact || start != total)
+    {
+        std::cerr << "ERROR: the sizes must sum to N+1, the last stratum ends at N" << std::endl;
+        strata.back().size = total - strata.back().start;
+    }
+    if (quotas.size() != strata.size())
+        std::cerr << "ERROR: one quota per stratum is needed, the missing ones are 0" << std::endl;
+
+    // One key schedule for all the strata, from a splitmix64 stream as BatchRNG does
+    uint64_t state = seed;
+    for (uint64_t r = 0; r < mix_rounds; r++)
+    {
+        mix_keys[r] = Strategy::splitmix64(state++);
+        mix_mults[r] = Strategy::splitmix64(state++) | 1;
+    }
+    const uint64_t stratum_keys = Strategy::splitmix64(state++);
+    const uint64_t slots_key = Strategy::splitmix64(state++);
+
+    bool quotas_ok = true;
+    slot_starts.push_back(0);
+    for (uint64_t s = 0; s < strata.size(); s++)
+    {
+        Stratum &st = strata[s];
+        const uint64_t quota = (s < quotas.size()) ? quotas[s] : 0;
+        quotas_ok &= quota <= st.size;
+        st.quota = std::min(quota, st.size);
+        init_stratum(st, Strategy::splitmix64(stratum_keys + s));
+        slot_starts.push_back(slot_starts.back() + st.quota);
+    }
+    if (!quotas_ok)
+        std::cerr << "ERROR: a quota is greater than its stratum, the size of the stratum is used" << std::endl;
+
+    slots = {0, slot_starts.back(), 0, 0, 0, 0};
+    init_stratum(slots, slots_key);
+}
+
+StratifiedSampler::~StratifiedSampler() {}
+
+void StratifiedSampler::init_stratum(Stratum &st, uint64_t key) const
+{
+    // The bits of a Super_rng of [0,size-1]: even, at least 2
+    uint64_t bits = (st.size <= 2) ? 1 : Strategy::bit_width(st.size - 1);
+    bits += bits % 2;
+    st.mask = (bits < 64) ? (1ull << bits) - 1 : 0xFFFFFFFFFFFFFFFFull;
+    st.shift = std::max(bits / 2, (uint64_t)1);
+    st.key = key & st.mask;
+}
+
+void StratifiedSampler::rewind()
+{
+    position = 0;
+}
+
+uint64_t StratifiedSampler::permute(const Stratum &st, uint64_t x) const
+{
+    // The rounds of Super_rng level 5 on the bits of the stratum, keyed by the stratum first
+    x ^= st.key;
+    x ^= x >> st.shift;
+    for (uint64_t r = 0; r < mix_rounds; r++)
+    {
+        x ^= mix_keys[r] & st.mask;
+        x = (x * mix_mults[r]) & st.mask;
+        x ^= x >> st.shift;
+    }
+    return x;
+}
+
+uint64_t StratifiedSampler::walk(const Stratum &st, uint64_t x) const
+{
+    // The domain of the stratum is less than 4 times its size: less than 4 permute() on average
+    do
+    {
+        x = permute(st, x);
+    } while (x >= st.size);
+    return x;
+}
+
+void StratifiedSampler::walk_lanes(const Stratum *const *st, const uint64_t *positions, uint64_t *out,
+                                   uint64_t n) const
+{
+    // As Super_rng::fill(): a lane takes the next position once its value is in the range of its stratum
+    if (n < lanes)
+    {
+        for (uint64_t t = 0; t < n; t++)
+            out[t] = st[t]->start + walk(*st[t], positions[t]);
+        return;
+    }
+    uint64_t x[lanes], slot[lanes], mask[lanes], shift[lanes], size[lanes];
+    uint64_t next = 0;
+    auto load = [&](uint64_t l)
+    {
+        x[l] = positions[next] ^ st[next]->key; // The first step of permute()
+        mask[l] = st[next]->mask;
+        shift[l] = st[next]->shift;
+        size[l] = st[next]->size;
+        slot[l] = next++;
+    };
+    for (uint64_t l = 0; l < lanes; l++)
+        load(l);
+    uint64_t busy = lanes;
+    while (busy > 0)
+    {
+        // The rounds of permute() on all the lanes at once
+        for (uint64_t l = 0; l < lanes; l++)
+            x[l] ^= x[l] >> shift[l];
+        for (uint64_t r = 0; r < mix_rounds; r++)
+        {
+            for (uint64_t l = 0; l < lanes; l++)
+            {
+                uint64_t y = (x[l] ^ mix_keys[r]) & mask[l];
+                y = (y * mix_mults[r]) & mask[l];
+                x[l] = y ^ (y >> shift[l]);
+            }
+        }
+        for (uint64_t l = 0; l < lanes; l++)
+        {
+            if (slot[l] == n)
+                continue;
+            if (x[l] >= size[l])
+            {
+                x[l] ^= st[slot[l]]->key; // Walks on
+                continue;
+            }
+            out[slot[l]] = st[slot[l]]->start + x[l];
+            if (next < n)
+                load(l);
+            else
+            {
+                slot[l] = n; // Idle
+                busy--;
+            }
+        }
+    }
+}
+
+uint64_t StratifiedSampler::slot_stratum(uint64_t slot) const
+{
+    // The last stratum starting at or before the slot: the strata without quota are skipped
+    return std::upper_bound(slot_starts.begin(), slot_starts.end(), slot) - slot_starts.begin() - 1;
+}
+
+uint64_t StratifiedSampler::at(uint64_t j) const
+{
+    const uint64_t slot = walk(slots, j);
+    const uint64_t s = slot_stratum(slot);
+    return strata[s].start + walk(strata[s], slot - slot_starts[s]);
+}
+
+bool StratifiedSampler::next(uint64_t &value)
+{
+    if (position == slots.size)
+        return false;
+    value = at(position++);
+    return true;
+}
+
+uint64_t StratifiedSampler::fill(uint64_t *out, uint64_t n)
+{
+    // Same values as next(), by chunks: the slots are walked in lanes, then searched together (the
+    // searches are independent, thus their loads overlap), then the members are walked in lanes
+    n = std::min(n, slots.size - position);
+    const Stratum *st[chunk];
+    uint64_t positions[chunk];
+    uint64_t base[chunk];
+    const uint64_t *starts = slot_starts.data();
+    for (uint64_t done = 0; done < n; done += chunk)
+    {
+        const uint64_t c = std::min(chunk, n - done);
+        for (uint64_t t = 0; t < c; t++)
+        {
+            positions[t] = position + done + t;
+            st[t] = &slots;
+        }
+        walk_lanes(st, positions, positions, c);
+
+        // Branch-free search of the last start <= slot, one step of all the slots at a time
+        for (uint64_t t = 0; t < c; t++)
+            base[t] = 0;
+        for (uint64_t len = slot_starts.size(); len > 1; len -= len / 2)
+        {
+            const uint64_t half = len / 2;
+            for (uint64_t t = 0; t < c; t++)
+                base[t] += half & (0 - (uint64_t)(starts[base[t] + half] <= positions[t]));
+        }
+        for (uint64_t t = 0; t < c; t++)
+        {
+            positions[t] -= starts[base[t]];
+            st[t] = &strata[base[t]];
+        }
+        walk_lanes(st, positions, out + done, c);
+    }
+    position += n;
+    return n;
+}
+
+uint64_t StratifiedSampler::member(uint64_t s, uint64_t j) const
+{
+    return strata[s].start + walk(strata[s], j);
+}
+
+void StratifiedSampler::fill(uint64_t s, uint64_t j, uint64_t *out, uint64_t n) const
+{
+    const Stratum *st[chunk];
+    uint64_t positions[chunk];
+    std::fill(st, st + chunk, &strata[s]);
+    for (uint64_t done = 0; done < n; done += chunk)
+    {
+        const uint64_t c = std::min(chunk, n - done);
+        for (uint64_t t = 0; t < c; t++)
+            positions[t] = j + done + t;
+        walk_lanes(st, positions, out + done, c);
+    }
+}
+
+uint64_t StratifiedSampler::stratum(uint64_t x) const
+{
+    // The last stratum starting at or before x, empty strata are skipped
+    auto it = std::upper_bound(strata.begin(), strata.end(), x,
+                               [](uint64_t v, const Stratum &st)
+                               { return v < st.start; });
+    return (uint64_t)(it - strata.begin()) - 1;
+}
+
+uint64_t StratifiedSampler::getNumStrata() const { return strata.size(); }
+uint64_t StratifiedSampler::getStart(uint64_t s) const { return strata[s].start; }
+uint64_t StratifiedSampler::getSize(uint64_t s) const { return strata[s].size; }
+uint64_t StratifiedSampler::getQuota(uint64_t s) const { return strata[s].quota; }
+uint64_t StratifiedSampler::getNumSamples() const { return slots.size; }
+uint64_t StratifiedSampler::getRemaining() const { return slots.size - position; }
+uint64_t StratifiedSampler::getMaxValue() const { return N; }
+const char *StratifiedSampler::GetName() const { return "Stratified"; }
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+#include "RNG.h"
+
+using namespace std;
+
+// Unique values of [0,N] with a quota per stratum, the strata being consecutive ranges of [0,N] of any sizes.
+// Stratum s is permuted on its own domain [0, 4^x[ (4^x < 4*size) and restricted to its range by cycle
+// walking, thus a value never comes from another stratum and small strata cost no more than large ones.
+// All the strata use the keys of one schedule: the multiply/xorshift rounds of SUPER5 on 64-bit words,
+// cut to the bits of the stratum, after a xor with a key of the stratum derived from the seed.
+// A stratum keeps its bounds, its quota and its keys, whatever the number of values drawn.
+// next() interleaves the strata by a permutation of the Q slots of the quotas (Q is their sum), made of the same
+// rounds: the slot q in [start(s), start(s)+quota(s)[ of the prefix sums of the quotas gives the member
+// q - start(s) of the stratum s. Any order of the slots is as likely, thus each value comes from a stratum
+// drawn in proportion to the quotas left. The slots of a chunk are searched together, in O(log(strata)).
+// at() reads the interleaved sample at any position, member() and fill() read one stratum directly.
+class StratifiedSampler
+{
+public:
+    // The sizes sum to N+1, quotas[s] <= sizes[s] values are drawn from the stratum s
+    StratifiedSampler(uint64_t N, const vector<uint64_t> &sizes, const vector<uint64_t> &quotas, uint64_t seed);
+    ~StratifiedSampler();
+
+    bool next(uint64_t &value);               // Next value of the interleaved sample, false once the quotas are drawn
+    uint64_t fill(uint64_t *out, uint64_t n); // Up to n values of next(), returns the count
+    void rewind();                            // Restarts the interleaved sample, the same series again
+    uint64_t at(uint64_t j) const;            // Value j of the interleaved sample, j < getNumSamples()
+
+    uint64_t member(uint64_t s, uint64_t j) const; // j-th value of the stratum s, j < getSize(s)
+    void fill(uint64_t s, uint64_t j, uint64_t *out, uint64_t n) const; // Values j to j+n-1 of the stratum s
+    uint64_t stratum(uint64_t x) const; // Stratum of x in [0,N]
+
+    uint64_t getNumStrata() const;
+    uint64_t getStart(uint64_t s) const;
+    uint64_t getSize(uint64_t s) const;
+    uint64_t getQuota(uint64_t s) const;
+    uint64_t getNumSamples() const; // Sum of the quotas
+    uint64_t getRemaining() const;  // Values left to next()
+    uint64_t getMaxValue() const;
+    const char *GetName() const;
+
+private:
+    static const uint64_t mix_rounds = 6;
+
+    struct Stratum
+    {
+        uint64_t start;
+        uint64_t size;
+        uint64_t quota;
+        uint64_t key;   // Xor of the stratum, within mask
+        uint64_t mask;  // Domain [0, 4^x[ of the stratum
+        uint64_t shift;
+    };
+
+    uint64_t N;
+    vector<Stratum> strata;
+    uint64_t mix_keys[mix_rounds];
+    uint64_t mix_mults[mix_rounds]; // Odd
+
+    vector<uint64_t> slot_starts; // Prefix sums of the quotas, slot_starts.back() = Q
+    Stratum slots;                // Permutation of [0,Q[ of the interleaved sample
+    uint64_t position = 0;        // Next position of next()
+
+    static const uint64_t lanes = 8;  // Positions walked together
+    static const uint64_t chunk = 256; // Values of fill() processed together
+
+    uint64_t permute(const Stratum &st, uint64_t x) const;
+    uint64_t walk(const Stratum &st, uint64_t x) const; // Cycle walking of permute() into [0,size[
+    // out[t] = start + walk() of positions[t] in *st[t]: the lanes walk independent cycles, their rounds overlap
+    void walk_lanes(const Stratum *const *st, const uint64_t *positions, uint64_t *out, uint64_t n) const;
+    void init_stratum(Stratum &st, uint64_t key) const;
+    uint64_t slot_stratum(uint64_t slot) const; // Stratum of a slot of [0,Q[
+};
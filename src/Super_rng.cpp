@@ -5,25 +5,33 @@
 #include <bitset>
 using namespace std;
 #include <iostream>
+#include <type_traits>
 
 #include "Super_rng.h"
 #include "RNG.h"
 
-Super_rng::Super_rng(uint64_t N, uint64_t K, uint64_t l, uint64_t seed) : Strategy(N, K, seed)
+template <typename W>
+Super_rng_t<W>::Super_rng_t(W N, W K, uint64_t l, uint64_t seed, bool walk) : StrategyT<W>(N, K, seed)
 {
     level = l;
+    this->walk = walk;
     init();
+    init_round_table();
 }
 
-Super_rng::Super_rng(uint64_t N, uint64_t K, uint64_t l) : Strategy(N, K)
+template <typename W>
+Super_rng_t<W>::Super_rng_t(W N, W K, uint64_t l) : StrategyT<W>(N, K)
 {
     level = l;
     init();
+    init_round_table();
 }
 
-Super_rng::~Super_rng() {}
+template <typename W>
+Super_rng_t<W>::~Super_rng_t() {}
 
-void Super_rng::init()
+template <typename W>
+void Super_rng_t<W>::init()
 {
 
     // Force the number of bits to be even (base 4)
@@ -33,30 +41,22 @@ void Super_rng::init()
         num_bits_base_4 += 1;
     }
     half_bits_base_4 = num_bits_base_4 / 2;
-
-    if (num_bits < 64)
-    {
-        xor_key = Strategy::rand64() % (1ull << num_bits_base_4);
-    }
-    else
-    {
-        xor_key = rand64();
-    }
+    half_mask = (half_bits_base_4 < 64) ? (1ull << half_bits_base_4) - 1ull : 0xFFFFFFFFFFFFFFFFull;
+    symmetry_mask = (num_bits < WORD_BITS) ? ((W)1 << num_bits) - 1 : MAX_WORD;
+    mix_mask = (num_bits_base_4 < WORD_BITS) ? ((W)1 << num_bits_base_4) - 1 : MAX_WORD;
+    mix_shift = std::max(half_bits_base_4, (uint64_t)1);
 
     /*  **** Bit Concat Init ***** */
 
-    i = 0; // We don't need a random offset for this method
-    if (num_bits < 64)
+    if (num_bits < WORD_BITS)
     {
-        limit_N_binary = 1 << (num_bits);
+        limit_N_binary = (W)1 << num_bits;
     }
     else
     {
-        limit_N_binary = MAX_UINT64;
+        limit_N_binary = MAX_WORD;
     }
 
-    const uint64_t num_bits_i_for_k = (uint64_t)std::max((uint64_t)std::ceil(std::log2(nb_samples)), (uint64_t)1);
-
     // Example A: if N=5 -> modulus=6 num_bits==3. K=4 -> nb_samples=5 we need 3 bits.
     // We may need to ignore 2 value max: 7, 6 . num_ignored_values=2
     // num_bits_for_K_and_ignored_values=log2(num_ignored_values+nb_samples+1)=3
@@ -65,72 +65,232 @@ void Super_rng::init()
     //  We may ignored 27 values 101, 102, 103, ... 127.
     //  num_bits_for_K_and_ignored_values=log2(num_ignored_values+nb_samples+1)=log2(27+51+1)=7
     //
-    uint64_t num_bits_for_K_and_ignored_values, num_ignored_values;
-    if (num_bits_base_4 < 64)
+    uint64_t num_bits_for_K_and_ignored_values;
+    W num_ignored_values;
+    if (num_bits_base_4 < WORD_BITS)
     {
-        num_ignored_values = (1ull << num_bits_base_4) - modulus;
+        num_ignored_values = ((W)1 << num_bits_base_4) - modulus;
     }
     else
     {
-        num_ignored_values = MAX_UINT64 - modulus;
+        num_ignored_values = MAX_WORD - modulus;
     }
 
-    num_bits_for_K_and_ignored_values = (uint64_t)std::ceil(std::log2(num_ignored_values + nb_samples + 1));
+    // ceil(log2(x+1)) is the bit width of x, computed exactly and without overflowing x+1
+    num_bits_for_K_and_ignored_values = StrategyT<W>::bit_width(num_ignored_values + nb_samples);
 
-    if (nb_samples < MAX_UINT64 && num_bits_for_K_and_ignored_values < MAX_UINT64)
+    if (num_bits_for_K_and_ignored_values < WORD_BITS)
     {
-        limit_K_binary = (1ull << num_bits_for_K_and_ignored_values);
+        limit_K_binary = ((W)1 << num_bits_for_K_and_ignored_values);
         control_mask = limit_K_binary - 1;
     }
     else
     {
-        limit_K_binary = MAX_UINT64;
+        limit_K_binary = MAX_WORD;
         control_mask = limit_K_binary;
     }
 
+    // When the counter fills every bit of the domain, bitconcat adds no random bit. Skipping the outputs
+    // above N then needs fewer than 2^skip_max_bits counters in all, walking them has no such bound.
+    full_counter = num_bits_for_K_and_ignored_values >= num_bits_base_4;
+    cycle_walking = full_counter && (walk || level == 5 || num_bits_base_4 > skip_max_bits);
+
+    init_keys();
+}
+
+// Key schedule and counter. The key storage is reused: after the first call it does not allocate.
+template <typename W>
+void Super_rng_t<W>::init_keys()
+{
+    if (num_bits_base_4 < WORD_BITS)
+    {
+        xor_key = StrategyT<W>::randW() % ((W)1 << num_bits_base_4);
+    }
+    else
+    {
+        xor_key = StrategyT<W>::randW();
+    }
+
+    i = 0; // We don't need a random offset for this method
+
     /*  **** Feistel recursive Init ***** */
 
+    recursive_keys.clear();
     build_keys_recurs(half_bits_base_4, 1, recursive_keys, min_recusive_word_size);
 
+    fc_keys.clear();
     for (uint64_t I = 0; I < fc_rounds; I++)
     {
-        uint64_t random = Strategy::rand64() % (1ull << half_bits_base_4);
+        uint64_t random = StrategyT<W>::rand64() & half_mask;
         fc_keys.push_back((uint64_t)random);
     }
+
+    // Drawn last and only for level 5, the other levels keep their series
+    if (level == 5)
+    {
+        for (uint64_t r = 0; r < mix_rounds; r++)
+        {
+            mix_keys[r] = StrategyT<W>::randW() & mix_mask;
+            mix_mults[r] = (StrategyT<W>::randW() | 1) & mix_mask;
+            // Newton iteration for the inverse modulo 2^WORD_BITS: m*m = 1 mod 8, then each step doubles the exact bits
+            W inv = mix_mults[r];
+            for (uint64_t b = 3; b < WORD_BITS; b *= 2)
+                inv *= (W)2 - mix_mults[r] * inv;
+            mix_inv_mults[r] = inv & mix_mask;
+        }
+    }
+}
+
+uint64_t feister_f(
+    uint64_t x,
+    uint64_t id,
+    uint64_t half_bits_base_4,
+    const vector<uint64_t> &fc_keys,
+    uint64_t MIN_WORD_SIZE);
+
+// Rounds of the recursive levels: one for SUPER2, 4 for SUPER3 and 128 for SUPER4
+static inline uint64_t recursive_rounds(uint64_t level)
+{
+    return (level == 2) ? 1 : (level == 3) ? 4 : 128;
+}
+
+template <typename W>
+uint64_t Super_rng_t<W>::table_entries() const
+{
+    // A table entry costs about one computed round: it pays once the rounds of the expected draws
+    // reach half the table (cycle walking adds rounds to most draws).
+    if (!tables || level < 2 || level > 4 || half_bits_base_4 > round_table_max_bits)
+        return 0;
+    const uint64_t size = (num_bits_base_4 <= round_table_max_bits) ? 1ull << num_bits_base_4 : 1ull << half_bits_base_4;
+    if ((long double)nb_samples * recursive_rounds(level) < size / 2)
+        return 0;
+    return size;
+}
+
+template <typename W>
+void Super_rng_t<W>::init_round_table()
+{
+    // The storage is reused
+    round_table.clear();
+    node_tables.clear();
+    table_countdown = 0;
+    const uint64_t size = table_entries();
+    if (size == 0)
+        return;
+    if (num_bits_base_4 <= round_table_max_bits)
+    {
+        round_table.resize(size);
+        for (uint64_t x = 0; x < size; x++)
+            round_table[x] = (uint16_t)round((W)x);
+        return;
+    }
+
+    // Larger words: feister_f() of a node only reads its own sub-word and the keys of its subtree, thus
+    // the two halves are tabulated apart. An entry replaces one of the two node calls of a round.
+    node_tables.resize(2 * size);
+    for (uint64_t x = 0; x < size; x++)
+    {
+        node_tables[x] = (uint16_t)feister_f(x, 2, half_bits_base_4 / 2, recursive_keys, min_recusive_word_size);
+        node_tables[size + x] =
+            (uint16_t)feister_f(x, 3, half_bits_base_4 / 2, recursive_keys, min_recusive_word_size);
+    }
+}
+
+template <typename W>
+void Super_rng_t<W>::defer_tables()
+{
+    // Re-keying must stay cheap: the tables of the old keys are dropped, the rounds are computed until
+    // the draws since the re-keying reach the break-even of init_round_table(). A generator reseeded
+    // for a few values never builds them, a long one pays at most twice the rounds of the table.
+    round_table.clear();
+    node_tables.clear();
+    const uint64_t size = table_entries();
+    table_countdown = (size == 0) ? 0 : std::max(size / 2 / recursive_rounds(level), (uint64_t)1);
+}
+
+template <typename W>
+void Super_rng_t<W>::count_draws(uint64_t n)
+{
+    if (n >= table_countdown)
+        init_round_table();
+    else
+        table_countdown -= n;
+}
+
+template <typename W>
+void Super_rng_t<W>::reseed(uint64_t seed)
+{
+    StrategyT<W>::reseed(seed);
+    init_keys();
+    defer_tables();
+}
+
+template <typename W>
+void Super_rng_t<W>::reset(W N, W K, uint64_t seed)
+{
+    StrategyT<W>::reset(N, K, seed);
+    init();
+    defer_tables();
+}
+
+template <typename W>
+uint64_t Super_rng_t<W>::getTableBytes() const
+{
+    return (round_table.size() + node_tables.size()) * sizeof(uint16_t);
+}
+
+template <typename W>
+void Super_rng_t<W>::useTables(bool use)
+{
+    tables = use;
+    init_round_table();
 }
 
-const char *Super_rng::GetName() const
+template <typename W>
+const char *Super_rng_t<W>::GetName() const
 {
     static char name[8]; // warning, we assume we will never use "SuperX" with X >= 10
     snprintf(name, sizeof(name), "Super%lu", level);
     return name;
 }
 
-uint64_t Super_rng::symmetry(uint64_t x) const
+static inline uint64_t reverse64(uint64_t x)
 {
-    for (uint64_t I = 0; I < half_bits_base_4; I++)
-    { // remember: "i" is the iteration variable name
-        uint64_t J = num_bits - I - 1;
-        uint64_t bit_i = (x >> I) & 1;
-        uint64_t bit_j = (x >> J) & 1;
-        uint64_t tmp = bit_i ^ bit_j;
-        tmp = (tmp << I) | (tmp << J);
-        x = tmp ^ x;
-    }
+    x = __builtin_bswap64(x);
+    x = ((x >> 4) & 0x0F0F0F0F0F0F0F0Full) | ((x & 0x0F0F0F0F0F0F0F0Full) << 4);
+    x = ((x >> 2) & 0x3333333333333333ull) | ((x & 0x3333333333333333ull) << 2);
+    x = ((x >> 1) & 0x5555555555555555ull) | ((x & 0x5555555555555555ull) << 1);
     return x;
 }
 
-uint64_t Super_rng::hadamard(uint64_t x) const
+template <typename W>
+W Super_rng_t<W>::symmetry(W x) const
 {
-    uint64_t L = x >> half_bits_base_4; // when x="11110" L="011" R="110"
-    uint64_t R = x & ((1ull << half_bits_base_4) - 1ull);
+    // Swapping each bit I < half_bits_base_4 with the bit num_bits-I-1 reverses the num_bits low bits.
+    // The reversal is done on 64-bit lanes with byte swaps instead of one bit per iteration.
+    W low = x & symmetry_mask;
+    W reversed = 0;
+    for (uint64_t lane = 0; lane < WORD_BITS / 64; lane++)
+    {
+        reversed = ((reversed << 32) << 32) | reverse64((uint64_t)low);
+        low = (low >> 32) >> 32;
+    }
+    reversed = reversed >> (WORD_BITS - num_bits);
+    return (x & ~symmetry_mask) | reversed;
+}
+
+template <typename W>
+W Super_rng_t<W>::hadamard(W x) const
+{
+    uint64_t L = (uint64_t)(x >> half_bits_base_4); // when x="11110" L="011" R="110"
+    uint64_t R = (uint64_t)x & half_mask;
 
     for (uint64_t r = 0; r < had_rounds; r++)
     {
 
         // Apply 1 round
-        uint64_t Rnext = (L + 2ull * R) % (1ull << half_bits_base_4);
-        uint64_t Lnext = (L + R) % (1ull << half_bits_base_4);
+        uint64_t Rnext = (L + 2ull * R) & half_mask;
+        uint64_t Lnext = (L + R) & half_mask;
 
         // Update for next round
         R = Rnext;
@@ -138,31 +298,81 @@ uint64_t Super_rng::hadamard(uint64_t x) const
     }
 
     // Concatenate R and L
-    uint64_t y = (R << half_bits_base_4) | L;
+    W y = ((W)R << half_bits_base_4) | L;
     return y;
 }
 
-uint64_t Super_rng::bitconcat(uint64_t x)
+template <typename W>
+W Super_rng_t<W>::mix(W x) const
+{
+    // Each step is a bijection modulo 2^num_bits_base_4: the xor with a key, the product with an odd
+    // number (carries only move bits upward) and the xorshift (moves the high half downward).
+    x ^= x >> mix_shift;
+    for (uint64_t r = 0; r < mix_rounds; r++)
+    {
+        x ^= mix_keys[r];
+        x = (x * mix_mults[r]) & mix_mask;
+        x ^= x >> mix_shift;
+    }
+    return x;
+}
+
+template <typename W>
+W Super_rng_t<W>::hadamard_inv(W x) const
+{
+    // (L, R) -> (L+R, L+2R) has determinant -1, thus R = R' - L' and L = L' - R
+    uint64_t Ln = (uint64_t)x & half_mask;
+    uint64_t Rn = (uint64_t)(x >> half_bits_base_4);
+    uint64_t R = (Rn - Ln) & half_mask;
+    uint64_t L = (Ln - R) & half_mask;
+    return ((W)L << half_bits_base_4) | R;
+}
+
+template <typename W>
+W Super_rng_t<W>::unxorshift(W x) const
+{
+    // Inverse of x ^= x >> mix_shift: the bits are recovered from the top, mix_shift at a time
+    W y = x;
+    for (uint64_t b = mix_shift; b < num_bits_base_4; b += mix_shift)
+        y = x ^ (y >> mix_shift);
+    return y;
+}
+
+template <typename W>
+W Super_rng_t<W>::mix_inv(W x) const
+{
+    for (uint64_t r = mix_rounds; r-- > 0;)
+    {
+        x = unxorshift(x);
+        x = (x * mix_inv_mults[r]) & mix_mask;
+        x ^= mix_keys[r];
+    }
+    return unxorshift(x);
+}
+
+template <typename W>
+W Super_rng_t<W>::bitconcat(W)
 { // limit_N_binary, control_mask, random_part are base 2 (the number of bits is any positive integer)
-    uint64_t random_part;
-    if (limit_N_binary < MAX_UINT64)
+    W random_part;
+    if (limit_N_binary < MAX_WORD)
     {
-        random_part = Strategy::rand64() % limit_N_binary;
+        random_part = StrategyT<W>::randW() % limit_N_binary;
     }
     else
     {
-        random_part = Strategy::rand64();
+        random_part = StrategyT<W>::randW();
     }
 
-    uint64_t out = (~control_mask & random_part) | ((control_mask)&i);
+    W out = (~control_mask & random_part) | ((control_mask)&i);
 
     return out;
 }
 
-uint64_t Super_rng::feistel(uint64_t x) const
+template <typename W>
+W Super_rng_t<W>::feistel(W x) const
 {
-    uint64_t L = x >> half_bits_base_4;
-    uint64_t R = x & ((1ULL << half_bits_base_4) - 1);
+    uint64_t L = (uint64_t)(x >> half_bits_base_4);
+    uint64_t R = (uint64_t)x & half_mask;
 
     // For each round of Feistel Cipher
     for (uint64_t r = 0; r < fc_rounds; r++)
@@ -174,7 +384,7 @@ uint64_t Super_rng::feistel(uint64_t x) const
         L = Lnext;
     }
 
-    uint64_t y = (R << half_bits_base_4) | L;
+    W y = ((W)R << half_bits_base_4) | L;
     return y;
 }
 
@@ -182,13 +392,7 @@ uint64_t feister_f(
     uint64_t x,
     uint64_t id,
     uint64_t half_bits_base_4,
-    unordered_map<uint64_t, uint64_t> &fc_keys,
-    uint64_t MIN_WORD_SIZE);
-uint64_t feister_f(
-    uint64_t x,
-    uint64_t id,
-    uint64_t half_bits_base_4,
-    unordered_map<uint64_t, uint64_t> &fc_keys,
+    const vector<uint64_t> &fc_keys,
     uint64_t MIN_WORD_SIZE)
 {
     uint64_t L = x >> half_bits_base_4;
@@ -198,7 +402,7 @@ uint64_t feister_f(
 
     // should be half_bits_base_4
     // cout << "I need:  " << id << endl;
-    uint64_t key = fc_keys.find((uint64_t)id)->second;
+    uint64_t key = fc_keys[id];
     // cout << "i got it" << endl;
 
     // one single round
@@ -219,23 +423,106 @@ uint64_t feister_f(
     }
 }
 
-void Super_rng::build_keys_recurs(uint64_t num_bits,
-                                  uint64_t id, // the root is id=1  . Each child is 2*id and 2*id + 1. -> allows to identify nodes with an integer
-                                  unordered_map<uint64_t, uint64_t> &keys,
-                                  const uint64_t MIN_WORD_SIZE)
+// Inverse of feister_f(): the sub-words are restored first, then the round is undone
+uint64_t feister_f_inv(
+    uint64_t y,
+    uint64_t id,
+    uint64_t half_bits_base_4,
+    const vector<uint64_t> &fc_keys,
+    uint64_t MIN_WORD_SIZE)
+{
+    uint64_t Ln = y & ((1ULL << half_bits_base_4) - 1);
+    uint64_t Rn = y >> half_bits_base_4;
+    if (half_bits_base_4 > MIN_WORD_SIZE)
+    {
+        Ln = feister_f_inv(Ln, 2 * id, half_bits_base_4 / 2, fc_keys, MIN_WORD_SIZE);
+        Rn = feister_f_inv(Rn, 2 * id + 1, half_bits_base_4 / 2, fc_keys, MIN_WORD_SIZE);
+    }
+    uint64_t R = Ln;
+    uint64_t L = Rn ^ (R ^ fc_keys[id]);
+    return (L << half_bits_base_4) | R;
+}
+
+// Root of the recursive Feistel network: the same as feister_f(x, 1, ...) but the halves of the
+// word are 64-bit lanes, the sub-words of the recursion fit in 32 bits.
+template <typename W>
+W Super_rng_t<W>::feistel_recurs(W x) const
+{
+    uint64_t L = (uint64_t)(x >> half_bits_base_4);
+    uint64_t R = (uint64_t)x & half_mask;
+
+    uint64_t key = recursive_keys[1];
+
+    // one single round
+    uint64_t Rnext = L ^ (R ^ key);
+    uint64_t Lnext = R;
+    R = Rnext;
+    L = Lnext;
+
+    if (!node_tables.empty())
+    {
+        L = node_tables[L];
+        R = node_tables[(half_mask + 1) + R];
+    }
+    else if (half_bits_base_4 > min_recusive_word_size)
+    {
+        L = feister_f(L, 2, half_bits_base_4 / 2, recursive_keys, min_recusive_word_size);
+        R = feister_f(R, 3, half_bits_base_4 / 2, recursive_keys, min_recusive_word_size);
+    }
+    return ((W)R << half_bits_base_4) | L;
+}
+
+template <typename W>
+W Super_rng_t<W>::feistel_inv(W x) const
+{
+    uint64_t L = (uint64_t)x & half_mask;
+    uint64_t R = (uint64_t)(x >> half_bits_base_4);
+    for (uint64_t r = fc_rounds; r-- > 0;)
+    {
+        uint64_t Lprev = R ^ (L ^ fc_keys[r]);
+        R = L;
+        L = Lprev;
+    }
+    return ((W)L << half_bits_base_4) | R;
+}
+
+template <typename W>
+W Super_rng_t<W>::feistel_recurs_inv(W x) const
+{
+    uint64_t Ln = (uint64_t)x & half_mask;
+    uint64_t Rn = (uint64_t)(x >> half_bits_base_4);
+    if (half_bits_base_4 > min_recusive_word_size)
+    {
+        Ln = feister_f_inv(Ln, 2, half_bits_base_4 / 2, recursive_keys, min_recusive_word_size);
+        Rn = feister_f_inv(Rn, 3, half_bits_base_4 / 2, recursive_keys, min_recusive_word_size);
+    }
+    uint64_t R = Ln;
+    uint64_t L = Rn ^ (R ^ recursive_keys[1]);
+    return ((W)L << half_bits_base_4) | R;
+}
+
+template <typename W>
+void Super_rng_t<W>::build_keys_recurs(uint64_t num_bits,
+                                       uint64_t id, // the root is id=1  . Each child is 2*id and 2*id + 1. -> allows to identify nodes with an integer
+                                       vector<uint64_t> &keys,
+                                       const uint64_t MIN_WORD_SIZE)
 {
     // add one number
     uint64_t random_part;
     if (num_bits < 64)
     {
-        random_part = Strategy::rand64() % (1ull << num_bits);
+        random_part = StrategyT<W>::rand64() % (1ull << num_bits);
     }
     else
     {
-        random_part = Strategy::rand64();
+        random_part = StrategyT<W>::rand64();
     }
     // cout << "insert: " << id << endl;
-    keys.insert({id, random_part});
+    if (keys.size() <= id)
+    {
+        keys.resize(id + 1);
+    }
+    keys[id] = random_part;
 
     if (num_bits < MIN_WORD_SIZE)
     {
@@ -249,12 +536,25 @@ void Super_rng::build_keys_recurs(uint64_t num_bits,
     }
 }
 
-uint64_t Super_rng::it()
+template <typename W>
+W Super_rng_t<W>::round(W x) const
 {
-    uint64_t out;
-
-    out = bitconcat(i);
+    x = hadamard(x);       // shuffle
+    x = feistel_recurs(x); // suffle but create local patterns
+    return symmetry(x);    // erase local patterns
+}
 
+template <typename W>
+W Super_rng_t<W>::permute(W out) const
+{
+    if (!round_table.empty())
+    {
+        // Levels 2 to 4: one load per round
+        out = symmetry(out);
+        for (uint64_t I = recursive_rounds(level); I > 0; I--)
+            out = round_table[(size_t)out];
+        return out;
+    }
     if (level == 0)
     {
         // out = out ^ xor_key;
@@ -271,18 +571,18 @@ uint64_t Super_rng::it()
     {
         out = symmetry(out); // uniform
 
-        out = hadamard(out);                                                               // shuffle
-        out = feister_f(out, 1, half_bits_base_4, recursive_keys, min_recusive_word_size); // suffle but create local patterns
-        out = symmetry(out);                                                               // erase local patterns
+        out = hadamard(out);       // shuffle
+        out = feistel_recurs(out); // suffle but create local patterns
+        out = symmetry(out);       // erase local patterns
     }
     else if (level == 3)
     {
         out = symmetry(out);
         for (int I = 0; I < 4; I++)
         {
-            out = hadamard(out);                                                               // shuffle
-            out = feister_f(out, 1, half_bits_base_4, recursive_keys, min_recusive_word_size); // suffle but create local patterns
-            out = symmetry(out);                                                               // erase local patterns
+            out = hadamard(out);       // shuffle
+            out = feistel_recurs(out); // suffle but create local patterns
+            out = symmetry(out);       // erase local patterns
         }
     }
     else if (level == 4)
@@ -290,12 +590,371 @@ uint64_t Super_rng::it()
         out = symmetry(out);
         for (int I = 0; I < 128; I++)
         {
-            out = hadamard(out);                                                               // shuffle
-            out = feister_f(out, 1, half_bits_base_4, recursive_keys, min_recusive_word_size); // suffle but create local patterns
-            out = symmetry(out);                                                               // erase local patterns
+            out = hadamard(out);       // shuffle
+            out = feistel_recurs(out); // suffle but create local patterns
+            out = symmetry(out);       // erase local patterns
+        }
+    }
+    else if (level == 5)
+    {
+        out = mix(out);
+    }
+    return out;
+}
+
+template <typename W>
+W Super_rng_t<W>::unpermute(W out) const
+{
+    // The stages of permute() in reverse order, symmetry() is its own inverse
+    if (level == 1)
+    {
+        out = symmetry(out);
+        out = feistel_inv(out);
+        out = hadamard_inv(out);
+        out = symmetry(out);
+    }
+    else if (level >= 2 && level <= 4)
+    {
+        for (uint64_t I = recursive_rounds(level); I > 0; I--)
+        {
+            out = symmetry(out);
+            out = feistel_recurs_inv(out);
+            out = hadamard_inv(out);
+        }
+        out = symmetry(out);
+    }
+    else if (level == 5)
+    {
+        out = mix_inv(out);
+    }
+    return out;
+}
+
+template <typename W>
+W Super_rng_t<W>::it()
+{
+    W out;
+
+    if (table_countdown != 0)
+        count_draws(1);
+
+    if (cycle_walking)
+    {
+        // Out-of-range outputs are permuted again instead of being rejected by RNG::it(), which would
+        // consume the next counter. No counter is wasted, thus the outputs remain unique. Without it, weak
+        // levels may map long runs of counters above N on large domains.
+        out = permute(i);
+        while (out > N)
+        {
+            out = permute(out);
         }
+        next_counter();
+        return out;
+    }
+    else if (full_counter)
+    {
+        // The random bits of bitconcat would all be masked: the output of the counter alone. It wraps at
+        // the end of the domain, thus RNG::it() finds a value in range after the last sample too.
+        out = permute(i & mix_mask);
+    }
+    else
+    {
+        out = bitconcat(i);
+        out = permute(out);
     }
 
     i++;
     return out;
 }
+
+template <typename W>
+bool Super_rng_t<W>::skip(W n)
+{
+    // Only the cycle walking mode computes the output from the counter alone
+    if (cycle_walking)
+    {
+        if (N == MAX_WORD)
+        {
+            i += n; // Wraps at 2^WORD_BITS = N+1
+            return true;
+        }
+        const W r = n % modulus;
+        i = (i >= modulus - r) ? i - (modulus - r) : i + r;
+        return true;
+    }
+    return false;
+}
+
+template <typename W>
+void Super_rng_t<W>::next_counter()
+{
+    // The cycle of a counter above N may lie entirely above N: the walk would never end
+    i = (i >= N) ? 0 : i + 1;
+}
+
+template <typename W>
+void Super_rng_t<W>::permute_lanes(W *x) const
+{
+    if (level == 5)
+    {
+        // mix() on all the lanes at once: their multiplication chains overlap
+        for (uint64_t l = 0; l < lanes; l++)
+            x[l] ^= x[l] >> mix_shift;
+        for (uint64_t r = 0; r < mix_rounds; r++)
+        {
+            for (uint64_t l = 0; l < lanes; l++)
+            {
+                W y = ((x[l] ^ mix_keys[r]) * mix_mults[r]) & mix_mask;
+                x[l] = y ^ (y >> mix_shift);
+            }
+        }
+    }
+    else if (!round_table.empty())
+    {
+        // The loads of the lanes are independent, they overlap
+        for (uint64_t l = 0; l < lanes; l++)
+            x[l] = symmetry(x[l]);
+        for (uint64_t I = recursive_rounds(level); I > 0; I--)
+            for (uint64_t l = 0; l < lanes; l++)
+                x[l] = round_table[(size_t)x[l]];
+    }
+    else
+    {
+        for (uint64_t l = 0; l < lanes; l++)
+            x[l] = permute(x[l]);
+    }
+}
+
+template <typename W>
+void Super_rng_t<W>::fill_skipping(W *out, uint64_t n)
+{
+    // Same values as it() and RNG::it(): the outputs of consecutive counters in order, the ones above N
+    // skipped. The lanes permute the next counters together, the counters left unused are not consumed.
+    W x[lanes];
+    uint64_t done = 0;
+    while (done < n)
+    {
+        for (uint64_t l = 0; l < lanes; l++)
+            x[l] = (i + l) & mix_mask; // As it(), the counter wraps at the end of the domain
+        permute_lanes(x);
+        uint64_t l = 0;
+        for (; l < lanes && done < n; l++)
+        {
+            out[done] = x[l];
+            done += x[l] <= N;
+        }
+        i += l;
+    }
+}
+
+template <typename W>
+void Super_rng_t<W>::fill(W *out, uint64_t n)
+{
+    // StrategyT<W>::fill() counts its draws in it()
+    if (table_countdown != 0 && (cycle_walking || full_counter))
+        count_draws(n);
+
+    if (!cycle_walking)
+    {
+        if (full_counter)
+            fill_skipping(out, n);
+        else
+            StrategyT<W>::fill(out, n);
+        return;
+    }
+
+    // Same values as it(): the output of the counter i, walked back into [0,N]. Each lane walks the cycle
+    // of one counter and takes the next counter once its value is in range, thus all the lanes stay busy.
+    if (n < lanes)
+    {
+        for (uint64_t j = 0; j < n; j++)
+            out[j] = it();
+        return;
+    }
+    W x[lanes];
+    uint64_t slot[lanes]; // n for an idle lane
+    W dummy;
+    uint64_t next = 0;
+    for (uint64_t l = 0; l < lanes; l++)
+    {
+        x[l] = i;
+        next_counter();
+        slot[l] = next++;
+    }
+    uint64_t busy = lanes;
+    while (busy > 0)
+    {
+        permute_lanes(x);
+        // Half of the values are out of range: selects instead of branches
+        for (uint64_t l = 0; l < lanes; l++)
+        {
+            const bool done = x[l] <= N && slot[l] != n;
+            *(done ? out + slot[l] : &dummy) = x[l];
+            const bool refill = done && next < n;
+            busy -= done && !refill;
+            x[l] = refill ? i : x[l];
+            slot[l] = refill ? next : (done ? n : slot[l]);
+            i += refill;
+            i = (i > N) ? 0 : i; // next_counter(), without a branch
+            next += refill;
+        }
+    }
+}
+
+// Bit reversal of a narrow word, as reverse64()
+template <typename T>
+static inline T reverse_narrow(T x)
+{
+    if constexpr (sizeof(T) == 4)
+    {
+        x = __builtin_bswap32(x);
+        x = ((x >> 4) & 0x0F0F0F0Fu) | ((x & 0x0F0F0F0Fu) << 4);
+        x = ((x >> 2) & 0x33333333u) | ((x & 0x33333333u) << 2);
+        x = ((x >> 1) & 0x55555555u) | ((x & 0x55555555u) << 1);
+    }
+    else
+    {
+        x = __builtin_bswap16(x);
+        x = (T)(((x >> 4) & 0x0F0F) | ((x & 0x0F0F) << 4));
+        x = (T)(((x >> 2) & 0x3333) | ((x & 0x3333) << 2));
+        x = (T)(((x >> 1) & 0x5555) | ((x & 0x5555) << 1));
+    }
+    return x;
+}
+
+template <typename W>
+template <typename T, uint64_t L>
+void Super_rng_t<W>::permute_lanes_narrow(T *x) const
+{
+    // The masks and keys have at most num_bits_base_4 <= 8*sizeof(T) bits, thus the stages modulo 2^(8*sizeof(T))
+    // give the same values as on W. 16-bit products are computed on 32 bits, without the promotion to int.
+    using C = typename std::conditional<sizeof(T) < 4, uint32_t, T>::type;
+    if (level == 5)
+    {
+        const uint64_t s = mix_shift;
+        const T mask = (T)mix_mask;
+        for (uint64_t l = 0; l < L; l++)
+            x[l] ^= (T)(x[l] >> s);
+        for (uint64_t r = 0; r < mix_rounds; r++)
+        {
+            const T key = (T)mix_keys[r], mult = (T)mix_mults[r];
+            for (uint64_t l = 0; l < L; l++)
+            {
+                T y = (T)((C)(T)(x[l] ^ key) * (C)mult) & mask;
+                x[l] = (T)(y ^ (y >> s));
+            }
+        }
+    }
+    else
+    {
+        // Level 1: symmetry, hadamard, feistel, symmetry
+        const uint64_t h = half_bits_base_4;
+        const T hm = (T)half_mask, sm = (T)symmetry_mask;
+        const uint64_t rshift = 8 * sizeof(T) - num_bits;
+        auto symmetry_lanes = [&]()
+        {
+            for (uint64_t l = 0; l < L; l++)
+                x[l] = (T)((x[l] & ~sm) | (reverse_narrow<T>((T)(x[l] & sm)) >> rshift));
+        };
+        symmetry_lanes();
+        for (uint64_t l = 0; l < L; l++)
+        {
+            C Lh = (C)x[l] >> h, R = (C)x[l] & hm;
+            C Rn = (Lh + 2 * R) & hm;
+            C Ln = (Lh + R) & hm;
+            x[l] = (T)((Rn << h) | Ln);
+        }
+        for (uint64_t r = 0; r < fc_rounds; r++)
+        {
+            const C key = (C)fc_keys[r];
+            for (uint64_t l = 0; l < L; l++)
+            {
+                C Lh = (C)x[l] >> h, R = (C)x[l] & hm;
+                x[l] = (T)(((Lh ^ (R ^ key)) << h) | R);
+            }
+        }
+        symmetry_lanes();
+    }
+}
+
+template <typename W>
+template <typename T>
+void Super_rng_t<W>::fill_narrow(T *out, uint64_t n)
+{
+    // Only the full counter of levels 1 and 5 has a narrow pipeline, the others fill W words
+    if (!full_counter || N > (W)(T)~(T)0 || (level != 1 && level != 5) || n < 64 / sizeof(T))
+    {
+        StrategyT<W>::fill_narrowed(out, n);
+        return;
+    }
+
+    const uint64_t L = 64 / sizeof(T);
+    const T max = (T)N;
+    if (!cycle_walking)
+    {
+        // As fill_skipping(), on T words
+        T y[L];
+        uint64_t done = 0;
+        while (done < n)
+        {
+            for (uint64_t l = 0; l < L; l++)
+                y[l] = (T)((i + l) & mix_mask);
+            permute_lanes_narrow<T, L>(y);
+            uint64_t l = 0;
+            for (; l < L && done < n; l++)
+            {
+                out[done] = y[l];
+                done += y[l] <= max;
+            }
+            i += l;
+        }
+        return;
+    }
+
+    // The lane pool of fill(W *), on T words
+    T x[L];
+    uint64_t slot[L]; // n for an idle lane
+    T dummy;
+    uint64_t next = 0;
+    for (uint64_t l = 0; l < L; l++)
+    {
+        x[l] = (T)i;
+        next_counter();
+        slot[l] = next++;
+    }
+    uint64_t busy = L;
+    while (busy > 0)
+    {
+        permute_lanes_narrow<T, L>(x);
+        for (uint64_t l = 0; l < L; l++)
+        {
+            const bool done = x[l] <= max && slot[l] != n;
+            *(done ? out + slot[l] : &dummy) = x[l];
+            const bool refill = done && next < n;
+            busy -= done && !refill;
+            x[l] = refill ? (T)i : x[l];
+            slot[l] = refill ? next : (done ? n : slot[l]);
+            i += refill;
+            i = (i > N) ? 0 : i; // next_counter(), without a branch
+            next += refill;
+        }
+    }
+}
+
+template <typename W>
+void Super_rng_t<W>::fill(uint32_t *out, uint64_t n)
+{
+    fill_narrow(out, n);
+}
+
+template <typename W>
+void Super_rng_t<W>::fill(uint16_t *out, uint64_t n)
+{
+    fill_narrow(out, n);
+}
+
+template <typename W>
+uint64_t Super_rng_t<W>::getDomainBits() const { return num_bits_base_4; }
+
+template class Super_rng_t<uint64_t>;
+template class Super_rng_t<uint128_t>;
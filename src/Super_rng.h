@@ -2,48 +2,125 @@
 
 #include <stdint.h>
 #include "Strategy.h"
-#include <unordered_map>
+#include <vector>
 
 using namespace std;
 
 
-class Super_rng : public Strategy
+// W is the word type (uint64_t or uint128_t). Hadamard and Feistel stages work on the two halves
+// of the word as 64-bit lanes, thus a 128-bit domain costs about the same as a 64-bit one.
+// When the counter fills every bit of the domain (K close to N), the outputs above N are either skipped
+// by RNG::it(), which then takes the next counter, or walked back into [0,N] (cycle walking): then the
+// value of a position is computed from the position alone (skip(), at()). Levels 0 to 4 skip them on
+// domains of up to 2^32 words, the series of the first versions. They walk on larger domains, where
+// weak levels may map long runs of counters above N, and with walk=true. SUPER5 always walks.
+template <typename W>
+class Super_rng_t : public StrategyT<W>
 {
 public:
-    Super_rng(uint64_t N, uint64_t K, uint64_t level, uint64_t seed);
-    Super_rng(uint64_t N, uint64_t K, uint64_t level);
+    Super_rng_t(W N, W K, uint64_t level, uint64_t seed, bool walk = false);
+    Super_rng_t(W N, W K, uint64_t level);
     void init();
-    uint64_t it();
+    void reseed(uint64_t seed);          // Same as a new Super_rng_t(N, K, level, seed), without allocation
+    void reset(W N, W K, uint64_t seed); // Same as a new Super_rng_t(N, K, level, seed), reusing the key storage
+                                         // Both defer the tables until the draws pay for them
+    W it(); // A value of [0, 2^getDomainBits()[ outside cycle walking, RNG::it() skips the ones above N
+    bool skip(W n);
+    void fill(W *out, uint64_t n); // Several counters are permuted together in the cycle walking mode
+    void fill(uint32_t *out, uint64_t n); // Levels 1 and 5 permute 32-bit lanes when N < 2^32
+    void fill(uint16_t *out, uint64_t n); // Levels 1 and 5 permute 16-bit lanes when N < 2^16
+    W permute(W x) const; // Bijection on [0, 2^getDomainBits()[, without the bitconcat step
+    W unpermute(W x) const; // Inverse of permute()
+    uint64_t getDomainBits() const;
+    uint64_t getTableBytes() const; // Round or node tables of levels 2 to 4, 0 when the rounds are computed (yet)
+    void useTables(bool use);       // Builds or drops them, the values are the same (default: true)
     const char* GetName() const;
-    ~Super_rng();
+    ~Super_rng_t();
 void build_keys_recurs(uint64_t num_bits, 
 uint64_t id,
-unordered_map<uint64_t, uint64_t>& keys,
+vector<uint64_t>& keys,
 const uint64_t MIN_WORD_SIZE
 );
 private:
+    using StrategyT<W>::N;
+    using StrategyT<W>::modulus;
+    using StrategyT<W>::nb_samples;
+    using StrategyT<W>::num_bits;
+    using StrategyT<W>::i;
+    using StrategyT<W>::WORD_BITS;
+    using StrategyT<W>::MAX_WORD;
+
     uint64_t num_bits_base_4;
     uint64_t half_bits_base_4;
     uint64_t half_bits;
+    uint64_t half_mask; // One 64-bit lane
+    W symmetry_mask;    // The num_bits low bits
 
     // XOR Cipher
-    uint64_t xor_key;
+    W xor_key;
 
     // Feister settings
     const uint64_t fc_rounds=1;
     vector<uint64_t> fc_keys;
     uint64_t level=0;
-    std::unordered_map<uint64_t , uint64_t > recursive_keys;
+    vector<uint64_t> recursive_keys; // Indexed by node id: the root is 1, the children of id are 2*id and 2*id+1
     const uint64_t min_recusive_word_size=2;
 
     // From BitConcat
-    uint64_t limit_N_binary;
-    uint64_t control_mask;
-    uint64_t limit_K_binary;
-
-    uint64_t bitconcat(uint64_t x);
-    uint64_t feistel(uint64_t x) const;
-    uint64_t symmetry(uint64_t x) const;
-    uint64_t hadamard(uint64_t x) const;
+    W limit_N_binary;
+    W control_mask;
+    W limit_K_binary;
+    bool full_counter;  // The counter fills every bit of the domain, bitconcat adds no random bit
+    bool walk = false;  // Cycle walking on every full counter domain
+    bool cycle_walking;
+    static const uint64_t skip_max_bits = 32; // Largest domain where levels 0 to 4 skip instead of walking
+
+    void init_keys();
+    void next_counter(); // Cycle walking: i wraps at N+1, thus every walk starts in [0,N] and ends
+    W bitconcat(W x);
+    W feistel(W x) const;
+    W feistel_recurs(W x) const;
+    W feistel_inv(W x) const;
+    W feistel_recurs_inv(W x) const;
+    W symmetry(W x) const;
+    W hadamard(W x) const;
+    W hadamard_inv(W x) const;
     const uint64_t had_rounds=1; // Does not systematically improves the OPERM5 metrics, but increases the uniform distrib.
+
+    // Levels 2 to 4 on small domains: one round (hadamard, feistel_recurs, symmetry) of every word of
+    // num_bits_base_4 bits, built by init_keys() when the values to draw pay for it. Empty otherwise.
+    static const uint64_t round_table_max_bits = 16; // 128 KB, within the L2 cache
+    vector<uint16_t> round_table;
+    // Domains of up to 2^32 words: feister_f() of the nodes 2 and 3, the two halves of feistel_recurs(),
+    // for every half of half_bits_base_4 bits (the table of node 3 follows the one of node 2).
+    vector<uint16_t> node_tables;
+    bool tables = true; // See useTables()
+    uint64_t table_countdown = 0; // Draws left before the deferred tables pay, 0 when none is deferred
+    W round(W x) const;
+    void init_round_table();
+    uint64_t table_entries() const; // Entries to compute, 0 when the draws expected do not pay for them
+    void defer_tables();
+    void count_draws(uint64_t n); // Builds the deferred tables once n draws reach table_countdown
+
+    // Level 5: keyed multiply/xorshift rounds on the num_bits_base_4 low bits
+    static const uint64_t mix_rounds = 6;
+    W mix_mask;
+    uint64_t mix_shift;
+    W mix_keys[mix_rounds];
+    W mix_mults[mix_rounds]; // Odd, thus invertible modulo 2^num_bits_base_4
+    W mix_inv_mults[mix_rounds]; // Inverses modulo 2^num_bits_base_4
+    W mix(W x) const;
+    W mix_inv(W x) const;
+    W unxorshift(W x) const; // Inverse of x ^= x >> mix_shift
+    static const uint64_t lanes = 8;
+    void permute_lanes(W *x) const; // permute() of lanes independent words
+    void fill_skipping(W *out, uint64_t n); // Full counter without cycle walking, see fill()
+    // Narrow path: the same stages on T words, 64 bytes of lanes (16 of 32 bits or 32 of 16 bits)
+    template <typename T>
+    void fill_narrow(T *out, uint64_t n);
+    template <typename T, uint64_t L>
+    void permute_lanes_narrow(T *x) const;
 };
+
+typedef Super_rng_t<uint64_t> Super_rng;
+typedef Super_rng_t<uint128_t> Super_rng128;
@@ -0,0 +1,55 @@
+#include <numeric>
+
+#include "Table_rng.h"
+
+using namespace std;
+
+template <typename W>
+Table_rng_t<W>::Table_rng_t(W N, W K, uint64_t seed) : StrategyT<W>(N, K, seed)
+{
+    init_table();
+}
+
+template <typename W>
+void Table_rng_t<W>::init_table()
+{
+    table.resize((size_t)N + 1);
+    std::iota(table.begin(), table.end(), (W)0);
+    i = 0;
+}
+
+template <typename W>
+void Table_rng_t<W>::reseed(uint64_t seed)
+{
+    StrategyT<W>::reseed(seed);
+    init_table();
+}
+
+template <typename W>
+void Table_rng_t<W>::reset(W N, W K, uint64_t seed)
+{
+    StrategyT<W>::reset(N, K, seed);
+    init_table();
+}
+
+template <typename W>
+W Table_rng_t<W>::it()
+{
+    if (i > N) // New pass
+        i = 0;
+    W j = i++;
+    W t = j + StrategyT<W>::randUpTo(N - j);
+    W v = table[(size_t)t];
+    table[(size_t)t] = table[(size_t)j];
+    table[(size_t)j] = v;
+    return v;
+}
+
+template <typename W>
+const char *Table_rng_t<W>::GetName() const
+{
+    return "Table";
+}
+
+template class Table_rng_t<uint64_t>;
+template class Table_rng_t<uint128_t>;
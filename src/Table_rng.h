@@ -0,0 +1,29 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include "Strategy.h"
+
+// K+1 values of a random permutation of [0,N], from a table of the N+1 values.
+// The table is shuffled lazily: it() is one step of Fisher-Yates, thus the construction only fills
+// the table in order and the sample is exactly uniform. Memory is (N+1) words: for small domains.
+// After N+1 values, the next pass shuffles the table again from its current order.
+template <typename W>
+class Table_rng_t : public StrategyT<W>
+{
+public:
+    Table_rng_t(W N, W K, uint64_t seed);
+    W it();
+    void reseed(uint64_t seed);
+    void reset(W N, W K, uint64_t seed);
+    const char *GetName() const;
+
+private:
+    using StrategyT<W>::N;
+    using StrategyT<W>::i;
+
+    std::vector<W> table;
+    void init_table();
+};
+
+typedef Table_rng_t<uint64_t> Table_rng;
@@ -0,0 +1,278 @@
+#include <math.h>
+#include <algorithm>
+
+#include "TestBattery.h"
+#include "OPERM5.h"
+
+using namespace std;
+
+// The smallest x of [0,N] in a cell >= b, N+1 if there is none
+static unsigned __int128 first_value(const TestBattery::Cells &c, uint64_t N, uint64_t b)
+{
+    if (c.of(N) < b)
+        return (unsigned __int128)N + 1;
+    uint64_t lo = 0, hi = N;
+    while (lo < hi)
+    {
+        uint64_t mid = lo + (hi - lo) / 2;
+        if (c.of(mid) < b)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+TestBattery::TestBattery(uint64_t N) : N(N)
+{
+    bits = (N == 0) ? 1 : 64 - __builtin_clzll(N);
+    ones.assign(64, 0);
+
+    middle = N / 2;
+
+    Cells quarters = make_cells(4);
+    gap_bound = (uint64_t)first_value(quarters, N, 1);
+    gaps.assign(gap_classes + 1, 0);
+
+    serial_cells = make_cells(16);
+    pairs.assign(serial_cells.probability.size() * serial_cells.probability.size(), 0);
+
+    const unsigned __int128 size = (unsigned __int128)N + 1;
+    birthday_ready = ((size & (size - 1)) == 0 && size >= ((unsigned __int128)1 << 24)) || size >= ((unsigned __int128)1 << 40);
+    if (birthday_ready)
+    {
+        days.mult = (uint64_t)(((unsigned __int128)1 << 88) / size);
+        group.reserve(birthdays);
+        spacings.resize(birthdays);
+        repeats.assign(41, 0);
+    }
+}
+
+TestBattery::Cells TestBattery::make_cells(uint64_t cells) const
+{
+    // mult = floor(cells * 2^64 / (N+1)): the cells hold floor or ceil of (N+1)/cells values.
+    // Their exact sizes come from their first values.
+    const unsigned __int128 size = (unsigned __int128)N + 1;
+    if ((unsigned __int128)cells >= size) // mult < 2^64: fewer cells than values, but one
+        cells = std::max((uint64_t)1, (uint64_t)size - 1);
+    Cells c;
+    c.mult = (uint64_t)(((unsigned __int128)cells << 64) / size); // 0 for N = 0: a single cell
+    std::vector<unsigned __int128> first(cells + 1, size);
+    for (uint64_t b = 0; b < cells; b++)
+        first[b] = first_value(c, N, b);
+    c.probability.resize(cells);
+    for (uint64_t b = 0; b < cells; b++)
+        c.probability[b] = (long double)(first[b + 1] - first[b]) / (long double)size;
+    return c;
+}
+
+void TestBattery::push(const uint64_t *values, uint64_t n)
+{
+    if (n == 0)
+        return;
+
+    // Bits: byte counters, bit k of each byte of acc[s] counts the bit 8 * byte + s of the values.
+    // 8 shifts per value instead of 64, flushed before a byte overflows.
+    for (uint64_t j0 = 0; j0 < n; j0 += 255)
+    {
+        const uint64_t m = std::min((uint64_t)255, n - j0);
+        uint64_t acc[8] = {0};
+        for (uint64_t t = 0; t < m; t++)
+            for (uint64_t s = 0; s < 8; s++)
+                acc[s] += (values[j0 + t] >> s) & 0x0101010101010101ull;
+        for (uint64_t s = 0; s < 8; s++)
+            for (uint64_t byte = 0; byte < 8; byte++)
+                ones[8 * byte + s] += (acc[s] >> (8 * byte)) & 0xFF;
+    }
+
+    // Runs: the switches between consecutive values, the first one against the last of the previous chunk
+    uint64_t a = values[0] > middle;
+    uint64_t s = (count > 0) ? (a ^ last_above) : 0;
+    for (uint64_t j = 1; j < n; j++)
+    {
+        a += values[j] > middle;
+        s += (values[j] > middle) != (values[j - 1] > middle);
+    }
+    above += a;
+    switches += s;
+    last_above = values[n - 1] > middle;
+
+    // Gap: the hits of 64 values as a mask, then the distances between its bits
+    for (uint64_t j0 = 0; j0 < n; j0 += 64)
+    {
+        const uint64_t m = std::min((uint64_t)64, n - j0);
+        uint64_t hits = 0;
+        for (uint64_t t = 0; t < m; t++)
+            hits |= (uint64_t)(values[j0 + t] < gap_bound) << t;
+        uint64_t position = 0;
+        while (hits != 0)
+        {
+            uint64_t t = __builtin_ctzll(hits);
+            gap += t - position;
+            if (gap_started)
+                gaps[std::min(gap, gap_classes)]++;
+            gap_started = true;
+            gap = 0;
+            position = t + 1;
+            hits &= hits - 1;
+        }
+        gap += m - position;
+    }
+
+    // Serial: non-overlapping pairs, a pair may span two chunks
+    const uint64_t cells = serial_cells.probability.size();
+    uint64_t j = 0;
+    if (has_pending)
+    {
+        pairs[serial_cells.of(pending) * cells + serial_cells.of(values[0])]++;
+        j = 1;
+    }
+    for (; j + 1 < n; j += 2)
+        pairs[serial_cells.of(values[j]) * cells + serial_cells.of(values[j + 1])]++;
+    has_pending = j < n;
+    pending = has_pending ? values[j] : 0;
+
+    // Birthday spacings: the days of a group are gathered, a full group is tested
+    if (birthday_ready)
+    {
+        for (uint64_t t = 0; t < n; t++)
+        {
+            group.push_back((uint32_t)days.of(values[t]));
+            if (group.size() == birthdays)
+                birthday_group();
+        }
+    }
+
+    count += n;
+}
+
+// LSD radix sort of values < 2^24, in 3 passes of 8 bits: a group costs a few scans instead of a comparison sort
+static void radix_sort24(std::vector<uint32_t> &v, std::vector<uint32_t> &scratch)
+{
+    scratch.resize(v.size());
+    for (uint32_t shift = 0; shift < 24; shift += 8)
+    {
+        uint32_t start[257] = {0};
+        for (uint32_t x : v)
+            start[((x >> shift) & 0xFF) + 1]++;
+        for (int d = 0; d < 256; d++)
+            start[d + 1] += start[d];
+        for (uint32_t x : v)
+            scratch[start[(x >> shift) & 0xFF]++] = x;
+        v.swap(scratch);
+    }
+}
+
+void TestBattery::birthday_group()
+{
+    radix_sort24(group, scratch);
+    spacings[0] = group[0];
+    for (uint64_t t = 1; t < birthdays; t++)
+        spacings[t] = group[t] - group[t - 1];
+    radix_sort24(spacings, scratch);
+    uint64_t repeated = 0;
+    for (uint64_t t = 1; t < birthdays; t++)
+        repeated += spacings[t] == spacings[t - 1];
+    repeats[std::min(repeated, (uint64_t)40)]++;
+    group.clear();
+}
+
+// Chi2 of the observed counts against the probabilities, the cells of probability 0 are left out
+static BatteryResult chi2_result(const char *name, const std::vector<uint64_t> &observed,
+                                 const std::vector<long double> &probability)
+{
+    uint64_t total = 0;
+    for (uint64_t o : observed)
+        total += o;
+    double chi2 = 0;
+    double cells = 0;
+    for (size_t c = 0; c < observed.size(); c++)
+    {
+        if (probability[c] <= 0)
+            continue;
+        double expected = (double)(probability[c] * total);
+        chi2 += ((double)observed[c] - expected) * ((double)observed[c] - expected) / expected;
+        cells++;
+    }
+    double pvalue = (total == 0 || cells < 2) ? NAN : chi2_pvalue(chi2, cells - 1);
+    return {name, chi2, cells - 1, pvalue, total};
+}
+
+std::vector<BatteryResult> TestBattery::results() const
+{
+    std::vector<BatteryResult> results;
+    const unsigned __int128 size = (unsigned __int128)N + 1;
+
+    // Bits: the sum of the squared z of the bits
+    double chi2 = 0;
+    double used = 0;
+    for (uint64_t b = 0; b < bits; b++)
+    {
+        const unsigned __int128 period = (unsigned __int128)1 << (b + 1);
+        const unsigned __int128 half = (unsigned __int128)1 << b;
+        const unsigned __int128 rest = size % period;
+        const unsigned __int128 set = (size / period) * half + (rest > half ? rest - half : 0);
+        const double p = (double)((long double)set / (long double)size);
+        if (p <= 0. || p >= 1.)
+            continue;
+        double z = ((double)ones[b] - count * p) / std::sqrt(count * p * (1. - p));
+        chi2 += z * z;
+        used++;
+    }
+    results.push_back({"bits", chi2, used, (count == 0 || used == 0) ? NAN : chi2_pvalue(chi2, used), count});
+
+    // Runs: Wald-Wolfowitz, given the numbers of values above and below
+    const double n1 = (double)above;
+    const double n2 = (double)(count - above);
+    const double n = (double)count;
+    double z = NAN;
+    if (n1 > 0 && n2 > 0 && count > 2)
+    {
+        double mean = 2. * n1 * n2 / n + 1.;
+        double variance = 2. * n1 * n2 * (2. * n1 * n2 - n) / (n * n * (n - 1.));
+        z = ((double)switches + 1. - mean) / std::sqrt(variance);
+    }
+    results.push_back({"runs", z, 0, std::isnan(z) ? NAN : normal_pvalue(z), count});
+
+    // Gap: geometric distribution of the gaps
+    const long double p = (long double)gap_bound / (long double)size;
+    std::vector<long double> geometric(gap_classes + 1);
+    for (uint64_t r = 0; r < gap_classes; r++)
+        geometric[r] = p * powl(1.L - p, (long double)r);
+    geometric[gap_classes] = powl(1.L - p, (long double)gap_classes);
+    results.push_back(chi2_result("gap", gaps, geometric));
+
+    // Serial: independent cells
+    const std::vector<long double> &q = serial_cells.probability;
+    std::vector<long double> product(q.size() * q.size());
+    for (size_t a = 0; a < q.size(); a++)
+        for (size_t b = 0; b < q.size(); b++)
+            product[a * q.size() + b] = q[a] * q[b];
+    results.push_back(chi2_result("serial", pairs, product));
+
+    // Birthday spacings: Poisson of mean birthdays^3 / (4 days) = 2, in cells 0 to 5 and >= 6
+    if (birthday_ready)
+    {
+        const long double lambda = 2.L;
+        std::vector<uint64_t> observed(7, 0);
+        std::vector<long double> probability(7, 0.L);
+        long double term = expl(-lambda);
+        for (uint64_t k = 0; k <= 40; k++)
+        {
+            observed[std::min(k, (uint64_t)6)] += repeats[k];
+            if (k < 6)
+                probability[k] = term;
+            term *= lambda / (long double)(k + 1);
+        }
+        long double below = 0;
+        for (size_t c = 0; c < 6; c++)
+            below += probability[c];
+        probability[6] = 1.L - below;
+        results.push_back(chi2_result("birthday", observed, probability));
+    }
+    else
+        results.push_back({"birthday", NAN, 0, NAN, 0});
+    return results;
+}
+
+uint64_t TestBattery::getCount() const { return count; }
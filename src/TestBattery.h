@@ -0,0 +1,91 @@
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+struct BatteryResult
+{
+    std::string name;
+    double statistic; // chi2, or z for the runs test
+    double dof;       // 0 for a normal statistic
+    double pvalue;    // Upper tail of the chi2, two-sided for z. NAN when the test did not run
+    uint64_t samples; // Values, pairs, gaps or groups behind the statistic
+};
+
+// Statistical tests of a stream of values of [0,N], all updated by the same pass: push() the output of a
+// generator in chunks of any size, then read results(). Each test keeps a few counters and handles a chunk
+// with branch-free loops over its values, thus multi-gigabyte outputs need no storage.
+// The expected frequencies are the exact ones of [0,N], whatever N, for independent uniform values:
+// samples without replacement fit them when K is much lower than N.
+//  - bits: ones of each bit of the values (chi2, one dof per bit of N)
+//  - runs: runs above and below the middle of [0,N] (Wald-Wolfowitz, normal)
+//  - gap: gaps between the values of the lowest quarter of [0,N], in 16 classes and beyond (chi2, 16 dof)
+//  - serial: non-overlapping pairs of values in 16 x 16 cells (chi2, 255 dof)
+//  - birthday: groups of 512 values as birthdays in 2^24 days, repeated spacings against Poisson(2)
+//    (chi2, 6 dof). Only for N+1 a power of two >= 2^24 or N+1 >= 2^40, where the days are uniform.
+class TestBattery
+{
+public:
+    TestBattery(uint64_t N);
+    void push(const uint64_t *values, uint64_t n);
+    std::vector<BatteryResult> results() const;
+    uint64_t getCount() const;
+
+    // Cells of equal width: of(x) is the high word of x * mult, the probabilities are exact
+    struct Cells
+    {
+        uint64_t mult;
+        std::vector<long double> probability;
+        inline uint64_t of(uint64_t x) const { return (uint64_t)(((unsigned __int128)x * mult) >> 64); }
+    };
+
+private:
+    uint64_t N;
+    uint64_t count = 0;
+
+    Cells make_cells(uint64_t cells) const;
+
+    uint64_t bits;
+    std::vector<uint64_t> ones; // Of the 64 bits
+
+    uint64_t middle; // Values > middle are above
+    uint64_t above = 0;
+    uint64_t switches = 0;
+    uint64_t last_above = 0;
+
+    static const uint64_t gap_classes = 16;
+    uint64_t gap_bound; // Values < gap_bound are hits
+    uint64_t gap = 0;   // Values since the last hit
+    bool gap_started = false; // The values before the first hit are no gap
+    std::vector<uint64_t> gaps;
+
+    Cells serial_cells;
+    std::vector<uint64_t> pairs;
+    bool has_pending = false;
+    uint64_t pending; // First value of a pair split by push()
+
+    static const uint64_t birthdays = 512;
+    bool birthday_ready;
+    Cells days;
+    std::vector<uint32_t> group;
+    std::vector<uint32_t> spacings;
+    std::vector<uint32_t> scratch;
+    std::vector<uint64_t> repeats; // Groups by number of repeated spacings, up to 40
+    void birthday_group();
+};
+
+// The battery on the n next values of a generator with fill(uint64_t *out, uint64_t n), in chunks
+template <typename G>
+std::vector<BatteryResult> RunBattery(G &generator, uint64_t N, uint64_t n)
+{
+    TestBattery battery(N);
+    std::vector<uint64_t> chunk(4096);
+    for (uint64_t done = 0; done < n; done += chunk.size())
+    {
+        uint64_t c = (n - done < chunk.size()) ? n - done : chunk.size();
+        generator.fill(chunk.data(), c);
+        battery.push(chunk.data(), c);
+    }
+    return battery.results();
+}
@@ -0,0 +1,62 @@
+/*
+ * Values per second through the C API: one foreign call per value against batched calls, and the
+ * native RNG::fill() of C++ on the same N and K (bench_capi_native.cpp).
+ * Build with 'make bench', run './bin/bench_capi'.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "rngwr.h"
+
+static volatile uint64_t sink; /* keeps the values alive */
+
+double native_values_per_s(int level, uint64_t batch, uint64_t total, uint64_t *check);
+
+static double now_s(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + 1e-9 * (double)t.tv_nsec;
+}
+
+static double values_per_s(rngwr_strategy strategy, uint64_t batch, uint64_t total)
+{
+    uint64_t *out = malloc(batch * sizeof(uint64_t));
+    rngwr_t *g = rngwr_create(0xFFFFFFFFFFFFFFFFull, total, strategy, 1);
+
+    double t1 = now_s();
+    for (uint64_t done = 0; done < total; done += batch)
+    {
+        rngwr_fill(g, out, batch);
+        sink ^= out[0];
+    }
+    double t2 = now_s();
+
+    rngwr_destroy(g);
+    free(out);
+    return (double)total / (t2 - t1);
+}
+
+int main(void)
+{
+    const uint64_t total = 1 << 22;
+    const uint64_t batches[] = {1, 16, 256, 4096};
+
+    for (int s = RNGWR_SUPER1; s <= RNGWR_SUPER3; s++)
+    {
+        for (size_t b = 0; b < sizeof(batches) / sizeof(batches[0]); b++)
+        {
+            double v = values_per_s((rngwr_strategy)s, batches[b], total);
+            printf("C API: Super%d batch: %lu values/s: %.3e ns/value: %.2f\n", s, (unsigned long)batches[b], v, 1e9 / v);
+        }
+        /* The largest batch, without the C API */
+        const uint64_t batch = batches[sizeof(batches) / sizeof(batches[0]) - 1];
+        uint64_t check = 0;
+        double v = native_values_per_s(s, batch, total, &check);
+        sink ^= check;
+        printf("NATIVE: Super%d RNG::fill batch: %lu values/s: %.3e ns/value: %.2f\n", s, (unsigned long)batch, v, 1e9 / v);
+    }
+    return EXIT_SUCCESS;
+}
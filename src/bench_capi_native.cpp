@@ -0,0 +1,26 @@
+/*
+ * Native row of bench_capi.c: RNG::fill() called from C++ on the same N and K as the C API rows.
+ * Linked with the objects of the library, not through the shared library.
+ */
+
+#include <stdint.h>
+
+#include <chrono>
+#include <vector>
+
+#include "RNG.h"
+
+extern "C" double native_values_per_s(int level, uint64_t batch, uint64_t total, uint64_t *check)
+{
+    std::vector<uint64_t> out(batch);
+    RNG g(0xFFFFFFFFFFFFFFFFull, total, (StrategyType)(SUPER0 + level), 1);
+
+    auto t1 = std::chrono::steady_clock::now();
+    for (uint64_t done = 0; done < total; done += batch)
+    {
+        g.fill(out.data(), batch);
+        *check ^= out[0];
+    }
+    auto t2 = std::chrono::steady_clock::now();
+    return (double)total / std::chrono::duration<double>(t2 - t1).count();
+}
@@ -0,0 +1,292 @@
+/*
+ * K+1 unique values out of [0,N]: every StrategyType implemented by RNG against the classic baselines (Fisher-Yates on an
+ * array, std::shuffle, Floyd's algorithm, rejection with a hash set, selection sampling in order).
+ * Each (method, N, K) runs in its own child process, thus the peak RSS reported by wait4() is its own.
+ * The allocations are counted by the global operator new of this program.
+ * Build with 'make bench', run './bin/bench_compare'. With '--calibrate', the cost model of the AUTO strategy is
+ * measured first, printed, and used by the Auto rows.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <malloc.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+#include <algorithm>
+#include <chrono>
+#include <new>
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "RNG.h"
+
+// Allocation counters of the current process (reset in each child)
+static uint64_t nb_allocs = 0;
+static uint64_t alloc_bytes = 0;
+static uint64_t live_bytes = 0;
+static uint64_t peak_bytes = 0;
+
+void *operator new(size_t size)
+{
+    void *p = malloc(size == 0 ? 1 : size);
+    if (p == nullptr)
+        throw std::bad_alloc();
+    size_t usable = malloc_usable_size(p);
+    nb_allocs++;
+    alloc_bytes += usable;
+    live_bytes += usable;
+    peak_bytes = std::max(peak_bytes, live_bytes);
+    return p;
+}
+
+void operator delete(void *p) noexcept
+{
+    if (p == nullptr)
+        return;
+    live_bytes -= malloc_usable_size(p);
+    free(p);
+}
+
+void operator delete(void *p, size_t) noexcept { operator delete(p); }
+void *operator new[](size_t size) { return operator new(size); }
+void operator delete[](void *p) noexcept { operator delete(p); }
+void operator delete[](void *p, size_t) noexcept { operator delete(p); }
+
+static volatile uint64_t sink; // keeps the values alive
+
+// Takes the values by chunks, as a consumer would
+struct Consumer
+{
+    uint64_t acc = 0;
+    inline void take(uint64_t v) { acc ^= v + (acc << 1); }
+    ~Consumer() { sink = acc; }
+};
+
+static const uint64_t CHUNK = 4096;
+
+static void run_strategy(StrategyType st, uint64_t N, uint64_t K)
+{
+    RNG generator(N, K, st, 1);
+    std::vector<uint64_t> out(CHUNK);
+    Consumer c;
+    for (uint64_t done = 0; done <= K; done += CHUNK)
+    {
+        uint64_t n = std::min(CHUNK, K - done + 1);
+        generator.fill(out.data(), n);
+        for (uint64_t t = 0; t < n; t++)
+            c.take(out[t]);
+    }
+}
+
+static void run_fisher_yates(uint64_t N, uint64_t K)
+{
+    // K+1 steps of Fisher-Yates on the materialized domain
+    std::mt19937_64 rng(1);
+    std::vector<uint64_t> a(N + 1);
+    for (uint64_t j = 0; j <= N; j++)
+        a[j] = j;
+    Consumer c;
+    for (uint64_t j = 0; j <= K; j++)
+    {
+        uint64_t t = std::uniform_int_distribution<uint64_t>(j, N)(rng);
+        std::swap(a[j], a[t]);
+        c.take(a[j]);
+    }
+}
+
+static void run_std_shuffle(uint64_t N, uint64_t K)
+{
+    // The whole domain is shuffled, whatever K
+    std::mt19937_64 rng(1);
+    std::vector<uint64_t> a(N + 1);
+    for (uint64_t j = 0; j <= N; j++)
+        a[j] = j;
+    std::shuffle(a.begin(), a.end(), rng);
+    Consumer c;
+    for (uint64_t j = 0; j <= K; j++)
+        c.take(a[j]);
+}
+
+static void run_floyd(uint64_t N, uint64_t K)
+{
+    // Floyd: for j in [N-K, N], t uniform in [0,j], j is taken when t already was. The set is unordered.
+    std::mt19937_64 rng(1);
+    std::unordered_set<uint64_t> taken;
+    taken.reserve(K + 1);
+    for (uint64_t j = N - K;; j++)
+    {
+        uint64_t t = std::uniform_int_distribution<uint64_t>(0, j)(rng);
+        if (!taken.insert(t).second)
+            taken.insert(j);
+        if (j == N)
+            break;
+    }
+    Consumer c;
+    for (uint64_t v : taken)
+        c.take(v);
+}
+
+static void run_rejection(uint64_t N, uint64_t K)
+{
+    // Uniform draws, the ones already seen are drawn again
+    std::mt19937_64 rng(1);
+    std::uniform_int_distribution<uint64_t> distr(0, N);
+    std::unordered_set<uint64_t> seen;
+    seen.reserve(K + 1);
+    Consumer c;
+    for (uint64_t j = 0; j <= K; j++)
+    {
+        uint64_t v;
+        do
+        {
+            v = distr(rng);
+        } while (!seen.insert(v).second);
+        c.take(v);
+    }
+}
+
+static void run_selection(uint64_t N, uint64_t K)
+{
+    // Knuth's algorithm S: one pass over [0,N], the values come in increasing order
+    std::mt19937_64 rng(1);
+    std::uniform_real_distribution<double> u(0.0, 1.0);
+    uint64_t needed = K + 1;
+    Consumer c;
+    for (uint64_t j = 0; needed > 0; j++)
+    {
+        if ((double)(N - j + 1) * u(rng) < (double)needed)
+        {
+            c.take(j);
+            needed--;
+        }
+    }
+}
+
+struct Method
+{
+    std::string name;
+    uint64_t max_values; // Larger K are skipped
+    uint64_t max_domain; // Larger N+1 are skipped, 0 for none
+    int strategy;        // -1 for a baseline
+    void (*run)(uint64_t N, uint64_t K);
+};
+
+struct Result
+{
+    double ns_per_value;
+    uint64_t allocs;
+    uint64_t alloc_bytes;
+    uint64_t peak_heap;
+};
+
+static void measure(const Method &m, uint64_t N, uint64_t K)
+{
+    int fds[2];
+    if (pipe(fds) != 0)
+        return;
+    fflush(stdout); // Not written twice by the child
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        close(fds[0]);
+        nb_allocs = alloc_bytes = live_bytes = peak_bytes = 0;
+        auto t1 = std::chrono::steady_clock::now();
+        if (m.strategy >= 0)
+            run_strategy((StrategyType)m.strategy, N, K);
+        else
+            m.run(N, K);
+        auto t2 = std::chrono::steady_clock::now();
+        Result r = {std::chrono::duration<double, std::nano>(t2 - t1).count() / ((double)K + 1.0), nb_allocs,
+                    alloc_bytes, peak_bytes};
+        ssize_t written = write(fds[1], &r, sizeof(r));
+        _exit(written == sizeof(r) ? 0 : 1);
+    }
+    close(fds[1]);
+    Result r;
+    bool ok = read(fds[0], &r, sizeof(r)) == sizeof(r);
+    close(fds[0]);
+    int status = 0;
+    struct rusage usage;
+    wait4(pid, &status, 0, &usage);
+    if (!ok || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+    {
+        printf("COMPARE: N+1: %.3g K+1: %.3g method: %-11s FAILED\n", (double)N + 1.0, (double)K + 1.0, m.name.c_str());
+        return;
+    }
+    printf("COMPARE: N+1: %.3g K+1: %.3g method: %-10s ns/value: %10.2f peak RSS: %8.1f MB allocs: %8lu alloc: %8.1f MB peak heap: %8.1f MB\n",
+           (double)N + 1.0, (double)K + 1.0, m.name.c_str(), r.ns_per_value, usage.ru_maxrss / 1024.0,
+           (unsigned long)r.allocs, r.alloc_bytes / 1048576.0, r.peak_heap / 1048576.0);
+    fflush(stdout);
+}
+
+static void print_cost_model(const AutoCostModel &m)
+{
+    printf("AUTO MODEL: super_setup_ns: %.0f super_permute_ns: {%.2f, %.2f, %.2f, %.2f, %.2f, %.2f} super_concat_ns: %.2f\n",
+           m.super_setup_ns, m.super_permute_ns[0], m.super_permute_ns[1], m.super_permute_ns[2], m.super_permute_ns[3],
+           m.super_permute_ns[4], m.super_permute_ns[5], m.super_concat_ns);
+    printf("AUTO MODEL: table_slot_ns: %.2f table_cached_ns: %.2f table_memory_ns: %.2f cache_bytes: %lu\n",
+           m.table_slot_ns, m.table_cached_ns, m.table_memory_ns, (unsigned long)m.cache_bytes);
+    printf("AUTO MODEL: sparse_setup_ns: %.0f sparse_value_ns: %.2f sparse_entry_bytes: %.0f\n\n", m.sparse_setup_ns,
+           m.sparse_value_ns, m.sparse_entry_bytes);
+}
+
+int main(int argc, char **argv)
+{
+    const uint64_t M = 1 << 20;
+    if (argc > 1 && strcmp(argv[1], "--calibrate") == 0)
+        auto_cost_model() = calibrate_auto_cost_model(); // Inherited by the children
+    print_cost_model(auto_cost_model());
+
+    // XOR, BC, XH and HF1 have no implementation behind RNG
+    std::vector<Method> methods = {
+        {"Super0", 16 * M, 0, SUPER0, nullptr},
+        {"Super1", 16 * M, 0, SUPER1, nullptr},
+        {"Super2", 16 * M, 0, SUPER2, nullptr},
+        {"Super3", M, 0, SUPER3, nullptr},
+        {"Super4", M / 16, 0, SUPER4, nullptr},
+        {"Super5", 16 * M, 0, SUPER5, nullptr},
+        {"Sorted", 16 * M, 0, SORTED, nullptr},
+        {"Auto", 16 * M, 0, AUTO, nullptr},
+        {"FisherYates", 16 * M, 64 * M, -1, run_fisher_yates},
+        {"std_shuffle", 16 * M, 64 * M, -1, run_std_shuffle},
+        {"Floyd", 16 * M, 0, -1, run_floyd},
+        {"Rejection", M, 0, -1, run_rejection},
+        {"Selection", 16 * M, 256 * M, -1, run_selection},
+    };
+
+    // K/N from 10^-6 to 1, on domains from 2^20 to 2^64; K is capped by the cost of each method
+    const double ratios[] = {1e-6, 1e-4, 1e-2, 1.0};
+    const uint64_t domains[] = {M - 1, 16 * M - 1, 0xFFFFFFFFull, 0xFFFFFFFFFFFFFFFFull};
+    for (uint64_t N : domains)
+    {
+        std::vector<uint64_t> ks;
+        for (double ratio : ratios)
+        {
+            long double k = ratio * ((long double)N + 1.0L);
+            if (k >= 1.0L && k <= 16.0L * M)
+                ks.push_back((uint64_t)k - 1);
+        }
+        if (N > 16 * M)
+            ks.push_back(M - 1); // Large domains: a fixed sample size
+        std::sort(ks.begin(), ks.end());
+        ks.erase(std::unique(ks.begin(), ks.end()), ks.end());
+
+        for (uint64_t K : ks)
+        {
+            for (const Method &m : methods)
+            {
+                if (K + 1 > m.max_values || (m.max_domain != 0 && (N >= m.max_domain)))
+                    continue;
+                measure(m, N, K);
+            }
+            printf("\n");
+        }
+    }
+    return EXIT_SUCCESS;
+}
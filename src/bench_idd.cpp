@@ -0,0 +1,159 @@
+/*
+ * IdServer under concurrent local clients: IDs per second and latency of a lease, for several numbers of
+ * client processes and lease sizes. The server runs in its own process with its checkpoint in /tmp.
+ * The clients mark the IDs they receive in a shared bitmap, a value received twice is reported.
+ * Build with 'make bench', run './bin/bench_idd'.
+ */
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "IdServer.h"
+
+static const uint64_t N = (1ull << 28) - 1;
+
+struct Shared
+{
+    std::atomic<uint64_t> duplicates;
+    std::atomic<uint64_t> received;
+    std::atomic<uint64_t> bitmap[(N + 1) / 64];
+};
+
+static pid_t start_server(const std::string &socket_path, const std::string &checkpoint_path)
+{
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        static IdServer *server;
+        IdServer s(socket_path, checkpoint_path, N, N, SUPER5, 1);
+        server = &s;
+        struct sigaction action = {};
+        action.sa_handler = [](int)
+        { server->stop(); };
+        sigaction(SIGTERM, &action, nullptr);
+        if (s.ok())
+            s.run();
+        printf("  server: issued: %lu checkpoints: %lu\n", s.getIssued(), s.getCheckpoints());
+        fflush(stdout);
+        _exit(s.ok() ? 0 : 1);
+    }
+    // Ready once it accepts connections
+    for (int t = 0; t < 1000; t++)
+    {
+        IdClient probe(socket_path);
+        if (probe.connected())
+            break;
+        usleep(1000);
+    }
+    return pid;
+}
+
+static void client(const std::string &socket_path, uint32_t lease, uint64_t leases, Shared *shared, int fd)
+{
+    IdClient c(socket_path);
+    std::vector<uint64_t> ids(lease);
+    std::vector<uint64_t> latencies(leases);
+    for (uint64_t l = 0; l < leases; l++)
+    {
+        auto t1 = std::chrono::steady_clock::now();
+        uint64_t got = c.lease(ids.data(), lease);
+        auto t2 = std::chrono::steady_clock::now();
+        latencies[l] = std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count();
+        for (uint64_t j = 0; j < got; j++)
+        {
+            uint64_t bit = 1ull << (ids[j] % 64);
+            if (shared->bitmap[ids[j] / 64].fetch_or(bit, std::memory_order_relaxed) & bit)
+                shared->duplicates++;
+        }
+        shared->received += got;
+    }
+    ssize_t written = write(fd, latencies.data(), latencies.size() * sizeof(uint64_t));
+    _exit(written == (ssize_t)(latencies.size() * sizeof(uint64_t)) ? 0 : 1);
+}
+
+static void measure(uint64_t clients, uint32_t lease, Shared *shared)
+{
+    const std::string socket_path = "/tmp/bench_idd_" + std::to_string(getpid()) + ".sock";
+    const std::string checkpoint_path = "/tmp/bench_idd_" + std::to_string(getpid()) + ".ckpt";
+    unlink(checkpoint_path.c_str());
+    shared->duplicates = 0;
+    shared->received = 0;
+    for (auto &word : shared->bitmap)
+        word.store(0, std::memory_order_relaxed);
+
+    // About 4 M values or 1000 leases per client
+    const uint64_t leases = std::max((uint64_t)1, std::min((uint64_t)1000, (uint64_t)(4 << 20) / (clients * lease)));
+    pid_t server = start_server(socket_path, checkpoint_path);
+
+    std::vector<pid_t> pids;
+    std::vector<int> fds;
+    auto t1 = std::chrono::steady_clock::now();
+    for (uint64_t c = 0; c < clients; c++)
+    {
+        int p[2];
+        if (pipe(p) != 0)
+            break;
+        fflush(stdout);
+        pid_t pid = fork();
+        if (pid == 0)
+        {
+            close(p[0]);
+            client(socket_path, lease, leases, shared, p[1]);
+        }
+        close(p[1]);
+        pids.push_back(pid);
+        fds.push_back(p[0]);
+    }
+
+    std::vector<uint64_t> latencies;
+    for (size_t c = 0; c < pids.size(); c++)
+    {
+        std::vector<uint64_t> l(leases);
+        size_t done = 0;
+        ssize_t r;
+        while (done < l.size() * sizeof(uint64_t) &&
+               (r = read(fds[c], (char *)l.data() + done, l.size() * sizeof(uint64_t) - done)) > 0)
+            done += r;
+        close(fds[c]);
+        waitpid(pids[c], nullptr, 0);
+        latencies.insert(latencies.end(), l.begin(), l.begin() + done / sizeof(uint64_t));
+    }
+    auto t2 = std::chrono::steady_clock::now();
+
+    double seconds = std::chrono::duration<double>(t2 - t1).count();
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&](double p)
+    { return latencies.empty() ? 0. : latencies[(size_t)(p * (latencies.size() - 1))] / 1000.; };
+    printf("IDD: clients: %3lu lease: %5u IDs/s: %12.0f leases/s: %9.0f latency(us) p50: %8.1f p99: %8.1f max: %8.1f "
+           "duplicates: %lu\n",
+           clients, lease, shared->received / seconds, latencies.size() / seconds, percentile(0.5), percentile(0.99),
+           percentile(1.0), shared->duplicates.load());
+    fflush(stdout);
+
+    kill(server, SIGTERM);
+    waitpid(server, nullptr, 0);
+    unlink(checkpoint_path.c_str());
+}
+
+int main(void)
+{
+    Shared *shared = (Shared *)mmap(nullptr, sizeof(Shared), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (shared == MAP_FAILED)
+        return EXIT_FAILURE;
+    for (uint64_t clients : {1, 8, 64})
+        for (uint32_t lease : {1, 100, 10000})
+            measure(clients, lease, shared);
+    munmap(shared, sizeof(Shared));
+    return EXIT_SUCCESS;
+}
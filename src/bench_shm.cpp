@@ -0,0 +1,103 @@
+/*
+ * SharedRNG under concurrent processes: values per second for several numbers of processes and claim sizes,
+ * against one process drawing from a private RNG. The processes mark the values they draw in a shared bitmap,
+ * a value drawn twice is reported.
+ * Build with 'make bench', run './bin/bench_shm'.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "SharedRNG.h"
+
+static const uint64_t N = (1ull << 24) - 1;
+
+struct Shared
+{
+    std::atomic<uint64_t> duplicates;
+    std::atomic<uint64_t> received;
+    std::atomic<uint64_t> bitmap[(N + 1) / 64];
+};
+
+static void worker(const std::string &name, uint64_t claim, Shared *shared)
+{
+    SharedRNG rng(name);
+    if (!rng.ok())
+        _exit(1);
+    std::vector<uint64_t> values(claim);
+    uint64_t got;
+    while ((got = rng.fill(values.data(), claim)) > 0)
+    {
+        for (uint64_t j = 0; j < got; j++)
+        {
+            uint64_t bit = 1ull << (values[j] % 64);
+            if (shared->bitmap[values[j] / 64].fetch_or(bit, std::memory_order_relaxed) & bit)
+                shared->duplicates++;
+        }
+        shared->received += got;
+    }
+    _exit(0);
+}
+
+static void measure(uint64_t processes, uint64_t claim, Shared *shared)
+{
+    const std::string name = "/bench_shm_" + std::to_string(getpid());
+    SharedRNG::remove(name);
+    shared->duplicates = 0;
+    shared->received = 0;
+    for (auto &word : shared->bitmap)
+        word.store(0, std::memory_order_relaxed);
+    SharedRNG creator(name, N, N, SUPER5, 1);
+
+    auto t1 = std::chrono::steady_clock::now();
+    std::vector<pid_t> pids;
+    for (uint64_t p = 0; p < processes; p++)
+    {
+        fflush(stdout);
+        pid_t pid = fork();
+        if (pid == 0)
+            worker(name, claim, shared);
+        pids.push_back(pid);
+    }
+    for (pid_t pid : pids)
+        waitpid(pid, nullptr, 0);
+    auto t2 = std::chrono::steady_clock::now();
+
+    double seconds = std::chrono::duration<double>(t2 - t1).count();
+    printf("SHM: processes: %2lu claim: %5lu values/s: %12.0f claims/s: %12.0f values: %lu duplicates: %lu\n",
+           processes, claim, shared->received / seconds, shared->received / seconds / claim,
+           shared->received.load(), shared->duplicates.load());
+    fflush(stdout);
+    SharedRNG::remove(name);
+}
+
+int main(void)
+{
+    // Baseline: one process, private generator, no bitmap
+    {
+        RNG rng(N, N, SUPER5, 1);
+        std::vector<uint64_t> values(4096);
+        auto t1 = std::chrono::steady_clock::now();
+        for (uint64_t done = 0; done <= N; done += values.size())
+            rng.fill(values.data(), values.size());
+        auto t2 = std::chrono::steady_clock::now();
+        printf("SHM: private RNG values/s: %12.0f\n", (N + 1) / std::chrono::duration<double>(t2 - t1).count());
+    }
+
+    Shared *shared = (Shared *)mmap(nullptr, sizeof(Shared), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (shared == MAP_FAILED)
+        return EXIT_FAILURE;
+    for (uint64_t processes : {1, 2, 4, 8})
+        for (uint64_t claim : {1, 64, 4096})
+            measure(processes, claim, shared);
+    munmap(shared, sizeof(Shared));
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,194 @@
+#include <new>
+#include <cstring>
+#include <algorithm>
+
+#include "rngwr.h"
+#include "RNG.h"
+
+// Serialized state: fixed-size array of 64-bit words, the words of the Mersenne Twister at STATE_WORDS
+static const uint64_t RNGWR_MAGIC = 0x33765257474e52ull; // "RNGWRv3"
+enum
+{
+    STATE_MAGIC,
+    STATE_STRATEGY,
+    STATE_N,
+    STATE_K,
+    STATE_SEED,
+    STATE_I,
+    STATE_DRAWS,
+    STATE_PRODUCED,
+    STATE_RNG_WORDS, // Used words of the Mersenne Twister
+    STATE_WORDS
+};
+static const size_t STATE_SIZE = (STATE_WORDS + Strategy::RNG_STATE_WORDS) * sizeof(uint64_t);
+
+struct rngwr
+{
+    RNG *rng;
+    rngwr_strategy strategy;
+    uint64_t N;
+    uint64_t K;
+    uint64_t produced; // Values written or skipped, at most the K+1 samples
+};
+
+// Count of the n next values within the samples left, which are then produced
+static uint64_t take(rngwr_t *g, uint64_t n)
+{
+    n = std::min(n, g->rng->getNumSamples() - g->produced);
+    g->produced += n;
+    return n;
+}
+
+static bool to_strategy_type(rngwr_strategy strategy, StrategyType &st)
+{
+    switch (strategy)
+    {
+    case RNGWR_SUPER0:
+        st = SUPER0;
+        return true;
+    case RNGWR_SUPER1:
+        st = SUPER1;
+        return true;
+    case RNGWR_SUPER2:
+        st = SUPER2;
+        return true;
+    case RNGWR_SUPER3:
+        st = SUPER3;
+        return true;
+    case RNGWR_SUPER4:
+        st = SUPER4;
+        return true;
+    case RNGWR_SUPER5:
+        st = SUPER5;
+        return true;
+    }
+    return false;
+}
+
+rngwr_t *rngwr_create(uint64_t N, uint64_t K, rngwr_strategy strategy, uint64_t seed)
+{
+    StrategyType st;
+    if (!to_strategy_type(strategy, st))
+        return nullptr;
+
+    rngwr_t *g = new (std::nothrow) rngwr_t;
+    if (g == nullptr)
+        return nullptr;
+    g->strategy = strategy;
+    g->N = N;
+    g->K = K;
+    g->produced = 0;
+    try
+    {
+        g->rng = new RNG(N, K, st, seed);
+    }
+    catch (...)
+    {
+        delete g;
+        return nullptr;
+    }
+    return g;
+}
+
+void rngwr_destroy(rngwr_t *g)
+{
+    if (g == nullptr)
+        return;
+    delete g->rng;
+    delete g;
+}
+
+uint64_t rngwr_fill(rngwr_t *g, uint64_t *out, uint64_t n)
+{
+    if (g == nullptr || out == nullptr)
+        return 0;
+    n = take(g, n);
+    g->rng->fill(out, n);
+    return n;
+}
+
+uint64_t rngwr_fill_u32(rngwr_t *g, uint32_t *out, uint64_t n)
+{
+    if (g == nullptr || out == nullptr || g->rng->getMaxValue() > 0xFFFFFFFFull)
+        return 0;
+    n = take(g, n);
+    g->rng->fill(out, n);
+    return n;
+}
+
+uint64_t rngwr_fill_u16(rngwr_t *g, uint16_t *out, uint64_t n)
+{
+    if (g == nullptr || out == nullptr || g->rng->getMaxValue() > 0xFFFFull)
+        return 0;
+    n = take(g, n);
+    g->rng->fill(out, n);
+    return n;
+}
+
+int rngwr_skip(rngwr_t *g, uint64_t n)
+{
+    if (g == nullptr)
+        return -1;
+    g->rng->skip(take(g, n));
+    return 0;
+}
+
+uint64_t rngwr_num_samples(const rngwr_t *g)
+{
+    if (g == nullptr)
+        return 0;
+    return g->rng->getNumSamples();
+}
+
+const char *rngwr_name(const rngwr_t *g)
+{
+    if (g == nullptr)
+        return "";
+    return g->rng->GetName();
+}
+
+size_t rngwr_serialize(const rngwr_t *g, void *buf, size_t size)
+{
+    if (g == nullptr)
+        return 0;
+    if (buf == nullptr || size < STATE_SIZE)
+        return STATE_SIZE;
+
+    Strategy *s = g->rng->getStrategy();
+    uint64_t state[STATE_WORDS + Strategy::RNG_STATE_WORDS] = {};
+    state[STATE_MAGIC] = RNGWR_MAGIC;
+    state[STATE_STRATEGY] = g->strategy;
+    state[STATE_N] = g->N;
+    state[STATE_K] = g->K;
+    state[STATE_SEED] = s->getSeed();
+    state[STATE_I] = s->getI();
+    state[STATE_DRAWS] = s->getDraws();
+    state[STATE_PRODUCED] = g->produced;
+    state[STATE_RNG_WORDS] = s->getRngState(state + STATE_WORDS);
+    std::memcpy(buf, state, STATE_SIZE);
+    return STATE_SIZE;
+}
+
+rngwr_t *rngwr_deserialize(const void *buf, size_t size)
+{
+    if (buf == nullptr || size < STATE_SIZE)
+        return nullptr;
+
+    uint64_t state[STATE_WORDS + Strategy::RNG_STATE_WORDS];
+    std::memcpy(state, buf, STATE_SIZE);
+    if (state[STATE_MAGIC] != RNGWR_MAGIC)
+        return nullptr;
+
+    rngwr_t *g = rngwr_create(state[STATE_N], state[STATE_K], (rngwr_strategy)state[STATE_STRATEGY], state[STATE_SEED]);
+    if (g == nullptr)
+        return nullptr;
+    // The Mersenne Twister is restored from its words, O(1) whatever the draws
+    if (state[STATE_PRODUCED] > g->rng->getNumSamples() ||
+        !g->rng->getStrategy()->restore(state[STATE_I], state[STATE_DRAWS], state + STATE_WORDS, state[STATE_RNG_WORDS]))
+    {
+        rngwr_destroy(g);
+        return nullptr;
+    }
+    g->produced = state[STATE_PRODUCED];
+    return g;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+/*
+ * C API of RNGWR, for embedding through FFI (librngwr.so / librngwr.a).
+ *
+ * Generators are opaque handles. Values are produced in batches with rngwr_fill(): one foreign
+ * call amortizes the FFI overhead over many values. No function throws or writes on a stream.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__GNUC__)
+#define RNGWR_API __attribute__((visibility("default")))
+#else
+#define RNGWR_API
+#endif
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    typedef struct rngwr rngwr_t;
+
+    /* Mixing levels, see StrategyType */
+    typedef enum
+    {
+        RNGWR_SUPER0 = 0,
+        RNGWR_SUPER1 = 1,
+        RNGWR_SUPER2 = 2,
+        RNGWR_SUPER3 = 3,
+        RNGWR_SUPER4 = 4,
+        RNGWR_SUPER5 = 5
+    } rngwr_strategy;
+
+    /* Draws K+1 unique values from [0,N]. Returns NULL on invalid arguments or allocation failure. */
+    RNGWR_API rngwr_t *rngwr_create(uint64_t N, uint64_t K, rngwr_strategy strategy, uint64_t seed);
+    RNGWR_API void rngwr_destroy(rngwr_t *g);
+
+    /* Writes the n next values in out, within the K+1 samples. Returns the number of values written,
+     * less than n once the samples run out (then 0). */
+    RNGWR_API uint64_t rngwr_fill(rngwr_t *g, uint64_t *out, uint64_t n);
+    /* The same values in 32-bit or 16-bit words. Returns 0 if N does not fit in the word. */
+    RNGWR_API uint64_t rngwr_fill_u32(rngwr_t *g, uint32_t *out, uint64_t n);
+    RNGWR_API uint64_t rngwr_fill_u16(rngwr_t *g, uint16_t *out, uint64_t n);
+
+    /* Discards the n next values, at most the samples left. Returns 0, or -1 on invalid handle. */
+    RNGWR_API int rngwr_skip(rngwr_t *g, uint64_t n);
+
+    RNGWR_API uint64_t rngwr_num_samples(const rngwr_t *g);
+    RNGWR_API const char *rngwr_name(const rngwr_t *g);
+
+    /* Saves the state in buf. Returns the size of the state, nothing is written if size is too small. */
+    RNGWR_API size_t rngwr_serialize(const rngwr_t *g, void *buf, size_t size);
+    /* New generator continuing the series of a serialized one, in O(1). Returns NULL on invalid state. */
+    RNGWR_API rngwr_t *rngwr_deserialize(const void *buf, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,48 @@
+/*
+ * Unique-ID daemon: serves the values of RNG(N, K, SUPERlevel, seed) to the local processes, see IdServer.h.
+ * Build with 'make daemon', run './bin/rngwr_idd <socket> <checkpoint> <N> [K=N] [level=5] [seed=0]'.
+ * SIGTERM and SIGINT stop it; restarted with the same checkpoint, it continues the sequence.
+ */
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "IdServer.h"
+
+static IdServer *server = nullptr;
+
+static void on_signal(int)
+{
+    if (server != nullptr)
+        server->stop();
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 4)
+    {
+        fprintf(stderr, "usage: %s <socket> <checkpoint> <N> [K=N] [level=5] [seed=0]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    uint64_t N = strtoull(argv[3], nullptr, 0);
+    uint64_t K = (argc > 4) ? strtoull(argv[4], nullptr, 0) : N;
+    uint64_t level = (argc > 5) ? strtoull(argv[5], nullptr, 0) : 5;
+    uint64_t seed = (argc > 6) ? strtoull(argv[6], nullptr, 0) : 0;
+
+    IdServer s(argv[1], argv[2], N, K, (StrategyType)(SUPER0 + std::min(level, (uint64_t)6)), seed);
+    if (!s.ok())
+        return EXIT_FAILURE;
+    server = &s;
+    struct sigaction action = {};
+    action.sa_handler = on_signal;
+    sigaction(SIGTERM, &action, nullptr);
+    sigaction(SIGINT, &action, nullptr);
+
+    printf("rngwr_idd: %s N: %lu K: %lu issued: %lu\n", argv[1], N, K, s.getIssued());
+    fflush(stdout);
+    s.run();
+    printf("rngwr_idd: stopped, issued: %lu checkpoints: %lu\n", s.getIssued(), s.getCheckpoints());
+    server = nullptr;
+    return EXIT_SUCCESS;
+}
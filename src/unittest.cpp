@@ -8,13 +8,38 @@
 
 #include <cmath> // contains gamma function in C++17
 #include <set>
+#include <numeric>
 
 // For timing below code
 #include <chrono>
 #include <thread>
 
+// For multi-process tests
+#include <unistd.h>
+#include <sys/wait.h>
+
+// For the memory-mapped file benchmark
+#include <fcntl.h>
+#include <sys/mman.h>
+
 #include "RNG.h"
 #include "OPERM5.h"
+#include "DistributedSampler.h"
+#include "rngwr.h"
+#include "PrefetchRNG.h"
+#include "PermutationFamily.h"
+#include "GridSampler.h"
+#include "BatchRNG.h"
+#include "LocalityRNG.h"
+#include "GrowingRNG.h"
+#include "RandomSplit.h"
+#include "Table_rng.h"
+#include "Sparse_rng.h"
+#include "IdServer.h"
+#include "SharedRNG.h"
+#include "TestBattery.h"
+#include "Constexpr_rng.h"
+#include "StratifiedSampler.h"
 
 uint64_t test_speed(const uint64_t N, const uint64_t K, const size_t runs, StrategyType st)
 {
@@ -46,6 +71,85 @@ uint64_t test_speed(const uint64_t N, const uint64_t K, const size_t runs, Strat
     return mean_ms;
 }
 
+uint64_t test_construction_speed(const uint64_t N, const uint64_t K, const size_t runs, StrategyType st)
+{
+    // Latency of a new generator compared to reseed() and reset() of an existing one
+    RNG generator{N, K, st, 0};
+    const char *name = generator.GetName();
+    uint64_t n = 0;
+
+    auto t1 = std::chrono::system_clock::now();
+    for (uint64_t r = 0; r < runs; ++r)
+    {
+        RNG fresh{N, K, st, r};
+        n ^= fresh.it();
+    }
+    auto t2 = std::chrono::system_clock::now();
+    for (uint64_t r = 0; r < runs; ++r)
+    {
+        generator.reseed(r);
+        n ^= generator.it();
+    }
+    auto t3 = std::chrono::system_clock::now();
+    for (uint64_t r = 0; r < runs; ++r)
+    {
+        generator.reset(N - (r & 1), K - (r & 1), r);
+        n ^= generator.it();
+    }
+    auto t4 = std::chrono::system_clock::now();
+
+    uint64_t new_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count() / runs;
+    uint64_t reseed_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(t3 - t2).count() / runs;
+    uint64_t reset_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(t4 - t3).count() / runs;
+    printf("CONSTRUCTION TEST: %s N: %lu K: %lu new(ns): %lu reseed(ns): %lu reset(ns): %lu\n", name, N, K, new_ns, reseed_ns, reset_ns);
+    return n;
+}
+
+uint64_t percentile(std::vector<uint64_t> &latencies, double p)
+{
+    std::sort(latencies.begin(), latencies.end());
+    return latencies[(size_t)(p * (latencies.size() - 1))];
+}
+
+void test_prefetch_latency(const uint64_t N, const uint64_t requests, const uint64_t request_us, StrategyType st)
+{
+    // One value per simulated request, the requests being request_us apart.
+    // Foreground: the value is computed on the request path. Prefetched: it is popped from the ring.
+    std::vector<uint64_t> foreground, prefetched;
+    uint64_t n = 0;
+    RNG generator{N, requests, st, 0};
+    PrefetchRNG prefetch{N, requests, st, 0, 1024, 256};
+    const char *name = generator.GetName();
+
+    for (uint64_t r = 0; r < 2 * requests; ++r)
+    {
+        auto t0 = std::chrono::steady_clock::now();
+        while (std::chrono::steady_clock::now() - t0 < std::chrono::microseconds(request_us))
+        {
+            // request work
+        }
+
+        auto t1 = std::chrono::steady_clock::now();
+        uint64_t value = 0;
+        if (r % 2 == 0)
+            value = generator.it();
+        else
+            prefetch.it(value);
+        n ^= value;
+        auto t2 = std::chrono::steady_clock::now();
+        uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count();
+        if (r % 2 == 0)
+            foreground.push_back(ns);
+        else
+            prefetched.push_back(ns);
+    }
+
+    printf("PREFETCH TEST: %s N: %lu requests: %lu foreground p50(ns): %lu p99(ns): %lu prefetched p50(ns): %lu p99(ns): %lu\n",
+           name, N, requests,
+           percentile(foreground, 0.5), percentile(foreground, 0.99),
+           percentile(prefetched, 0.5), percentile(prefetched, 0.99));
+}
+
 void visual_inspection(const uint64_t N, const uint64_t K, const size_t runs, StrategyType st)
 {
     for (uint64_t r = 0; r < runs; ++r)
@@ -242,137 +346,2404 @@ uint64_t test_N_K_API(uint64_t N, uint64_t K, uint64_t runs, StrategyType st)
     return fails;
 }
 
-void SHORT_UNIT_TEST(std::vector<StrategyType> &strategies)
+uint64_t test_baseline_series()
 {
-    uint64_t runs = 3;
-    for (const StrategyType &strat : strategies)
+    // Hashes of series produced by the first version of RNG (before the 128-bit engine), by it() and fill()
+    struct Series
     {
-        test_no_repeat(0, 0, runs, strat);
-        test_no_repeat(1, 1, runs, strat);
-        test_no_repeat(1, 0, runs, strat);
-        test_no_repeat(3, 3, runs, strat);
-        test_no_repeat(4, 4, runs, strat);
-        test_no_repeat(5, 4, runs, strat);
+        uint64_t N, K, level, seed, n, hash;
+    };
+    const Series series[] = {
+        {100, 10, 0, 0, 11, 0x5426e421844a1146ull},
+        {5, 4, 1, 0, 5, 0x43a0f288d284000dull},
+        {127, 127, 1, 1, 128, 0x65134f6c298d0cd3ull},
+        {100000000, 1000000, 1, 0, 20000, 0x5ca2a2ffeb36df00ull},
+        {0xFFFFFFFFFFFFFFFFull, 100000, 1, 1, 20000, 0x0f6c6bb5e9317569ull},
+        {100, 50, 2, 1, 51, 0x01de880b47f1f2a4ull},
+        {1000, 1000, 2, 0, 1001, 0x4e64b32e7c1146d3ull},
+        {65535, 65535, 2, 0, 20000, 0x6610e2ab0544213full},
+        {100, 100, 3, 0, 101, 0x2b506abad2d07eadull},
+        {1000000, 10000, 3, 1, 10001, 0x859b5397ad003b1cull},
+        {2147483648ull, 1000, 3, 0, 1001, 0x3133201c4d3c0cf7ull},
+        {256, 256, 4, 0, 257, 0xf939ece7f6d733bbull},
+        {65535, 255, 4, 1, 256, 0xfcc48c1a9b0ead1aull},
+    };
+    uint64_t fails = 0;
+    for (const Series &s : series)
+    {
+        RNG by_it(s.N, s.K, (StrategyType)(SUPER0 + s.level), s.seed);
+        RNG by_fill(s.N, s.K, (StrategyType)(SUPER0 + s.level), s.seed);
+        std::vector<uint64_t> values(s.n);
+        by_fill.fill(values.data(), s.n);
+        uint64_t hash_it = 1469598103934665603ull, hash_fill = hash_it; // FNV-1a on whole values
+        for (uint64_t j = 0; j < s.n; j++)
+        {
+            hash_it = (hash_it ^ by_it.it()) * 1099511628211ull;
+            hash_fill = (hash_fill ^ values[j]) * 1099511628211ull;
+        }
+        if (hash_it != s.hash || hash_fill != s.hash)
+        {
+            printf("SERIES FAIL: %s N: %lu K: %lu seed: %lu differs from the first version \n", by_it.GetName(), s.N, s.K,
+                   s.seed);
+            fails += 1;
+        }
+    }
+    return fails;
+}
 
-        test_no_repeat(10, 2, runs * 5, strat);
-        test_no_repeat(100, 10, runs * 10, strat);
-        test_no_repeat(100, 50, runs * 2, strat);
-        test_no_repeat(100, 100, runs, strat);
+uint64_t test_walk_past_the_end(uint64_t N, uint64_t level, uint64_t seed)
+{
+    // In the cycle walking mode the counter wraps at N+1: it() and fill() after the N+1 samples of K = N
+    // end, and give the permutation again. Large domains skip to the last 5 samples.
+    uint64_t fails = 0;
+    Super_rng generator(N, N, level, seed, true);
+    Super_rng first_pass(N, N, level, seed, true);
+    const uint64_t n = std::min(N, (uint64_t)999) + 1;
+    std::vector<uint64_t> expected(n), out(n);
+    if (n == N + 1)
+        generator.fill(out.data(), n);
+    else
+    {
+        generator.skip(N - 4);
+        for (uint64_t j = 0; j < 5; j++)
+            generator.it();
+    }
+    for (uint64_t j = 0; j < n; j++)
+    {
+        expected[j] = first_pass.it();
+        out[j] = generator.it();
+    }
+    if (out != expected)
+    {
+        printf("WALK PAST THE END FAIL: %s N: %lu seed: %lu it() \n", generator.GetName(), N, seed);
+        fails += 1;
+    }
+    generator.fill(out.data(), n);
+    first_pass.fill(expected.data(), n);
+    if (out != expected)
+    {
+        printf("WALK PAST THE END FAIL: %s N: %lu seed: %lu fill() \n", generator.GetName(), N, seed);
+        fails += 1;
+    }
+    return fails;
+}
 
-        test_no_repeat(127, 127, runs, strat);
-        test_no_repeat(128, 128, runs, strat);
-        test_no_repeat(255, 255, runs, strat);
-        test_no_repeat(256, 256, runs, strat);
+uint64_t test_past_the_end(uint64_t N, uint64_t K, uint64_t seed, StrategyType st)
+{
+    // it() and fill() after the K+1 samples end with values in [0,N]. With K = N they give the
+    // permutation again (SUPER5 walks, the other levels skip on these domains).
+    uint64_t fails = 0;
+    RNG generator(N, K, st, seed);
+    const uint64_t n = generator.getNumSamples();
+    std::vector<uint64_t> first(n), again(n), filled(n);
+    for (uint64_t j = 0; j < n; j++)
+        first[j] = generator.it();
+    for (uint64_t j = 0; j < n; j++)
+        again[j] = generator.it();
+    generator.fill(filled.data(), n);
+    bool in_range = std::all_of(again.begin(), again.end(), [N](uint64_t v) { return v <= N; }) &&
+                    std::all_of(filled.begin(), filled.end(), [N](uint64_t v) { return v <= N; });
+    if (!in_range || (K == N && (again != first || filled != first)))
+    {
+        printf("PAST THE END FAIL: %s N: %lu K: %lu seed: %lu \n", generator.GetName(), N, K, seed);
+        fails += 1;
     }
+    return fails;
+}
 
-    for (const StrategyType &strat : strategies)
+uint64_t test_sorted(uint64_t N, uint64_t K, uint64_t runs)
+{
+    // SORTED must emit K+1 distinct values in strictly increasing order
+    uint64_t fails = 0;
+    for (uint64_t r = 0; r < runs; ++r)
     {
+        RNG generator(N, K, SORTED, r);
+        uint64_t prev = 0;
+        for (uint64_t j = 0; j < generator.getNumSamples(); j++)
+        {
+            uint64_t rand_num = generator.it();
+            if (rand_num > N || (j > 0 && rand_num <= prev))
+            {
+                printf("SORTED FAIL: %s N: %lu K: %lu j: %lu value: %lu prev: %lu\n", generator.GetName(), N, K, j,
+                       rand_num, prev);
+                fails += 1;
+                break;
+            }
+            prev = rand_num;
+        }
+    }
+    return fails;
+}
 
-        test_N_K_API(0, 0, runs, strat);
-        test_N_K_API(1, 1, runs, strat);
-        test_N_K_API(3, 3, runs, strat);
-        test_N_K_API(5, 4, runs, strat);
+uint64_t test_distributed_sampler(uint64_t N, uint64_t world_size, uint64_t epochs, StrategyType st)
+{
+    // Each rank runs in its own process and sends its share to the parent through a pipe.
+    const uint64_t seed = 42;
+    uint64_t fails = 0;
+    std::vector<uint64_t> previous_epoch;
 
-        test_N_K_API(10, 2, runs * 5, strat);
-        test_N_K_API(100, 10, runs * 10, strat);
-        test_N_K_API(100, 50, runs, strat);
-        test_N_K_API(100, 100, runs, strat);
+    for (uint64_t e = 0; e < epochs; ++e)
+    {
+        std::vector<uint64_t> permutation(N + 1, 0);
+        std::vector<uint64_t> seen(N + 1, 0);
+        uint64_t total = 0;
 
-        test_N_K_API(127, 127, runs, strat);
-        test_N_K_API(128, 128, runs, strat);
-        test_N_K_API(255, 255, runs, strat);
-        test_N_K_API(256, 256, runs, strat);
+        for (uint64_t r = 0; r < world_size; ++r)
+        {
+            int fd[2];
+            if (pipe(fd) != 0)
+                return fails + 1;
+
+            pid_t pid = fork();
+            if (pid == 0)
+            {
+                close(fd[0]);
+                DistributedSampler sampler(N, st, seed, r, world_size);
+                sampler.set_epoch(e);
+                for (uint64_t j = 0; j < sampler.getNumSamples(); ++j)
+                {
+                    uint64_t v = sampler.it();
+                    if (write(fd[1], &v, sizeof(v)) != sizeof(v))
+                        _exit(1);
+                }
+                close(fd[1]);
+                _exit(0);
+            }
+
+            close(fd[1]);
+            uint64_t v;
+            uint64_t j = r; // global position of the received value
+            while (read(fd[0], &v, sizeof(v)) == sizeof(v))
+            {
+                if (v > N)
+                {
+                    printf("SAMPLER N FAILS: %lu > %lu \n", v, N);
+                    fails += 1;
+                    continue;
+                }
+                seen[v]++;
+                permutation[j] = v;
+                j += world_size;
+                total++;
+            }
+            close(fd[0]);
+            int status;
+            waitpid(pid, &status, 0);
+        }
+
+        // Coverage and disjointness: every value of [0,N] received exactly once
+        uint64_t missing = 0;
+        for (uint64_t v = 0; v <= N; ++v)
+        {
+            if (seen[v] != 1)
+                missing++;
+        }
+        if (missing != 0 || total != N + 1)
+        {
+            printf("SAMPLER COVERAGE FAIL: N: %lu world_size: %lu epoch: %lu \n", N, world_size, e);
+            fails += 1;
+        }
+
+        // Restart reproducibility: a new sampler gives the same share
+        DistributedSampler replay(N, st, seed, world_size - 1, world_size);
+        replay.set_epoch(e);
+        for (uint64_t j = world_size - 1; j <= N; j += world_size)
+        {
+            if (replay.it() != permutation[j])
+            {
+                printf("SAMPLER REPLAY FAIL: N: %lu world_size: %lu epoch: %lu \n", N, world_size, e);
+                fails += 1;
+                break;
+            }
+        }
+
+        if (N > 8 && permutation == previous_epoch)
+        {
+            printf("SAMPLER EPOCH FAIL: same order at epoch %lu \n", e);
+            fails += 1;
+        }
+        previous_epoch = permutation;
     }
+    return fails;
 }
 
-void BIG_UNIT_TEST(std::vector<StrategyType> &strategies)
+// 128-bit words cannot be printed with printf, they are shown as "2^x" or hexadecimal
+std::string str128(uint128_t x)
 {
-    uint64_t runs = 1;
+    char buf[40];
+    if (x == ~(uint128_t)0)
+        return "2^128-1";
+    snprintf(buf, sizeof(buf), "0x%lx%016lx", (uint64_t)(x >> 64), (uint64_t)x);
+    return std::string(buf);
+}
 
-    for (const StrategyType &strat : strategies)
-    {
-        test_no_repeat(100 * 1000000, 1000000, runs, strat);
-        test_no_repeat(0xFFFFFFFFFFFFFFFFull, 100000, runs, strat);
-        test_no_repeat(1000000, 10000, runs, strat);
-        test_no_repeat(1000, 1000, runs, strat);
-    }
+// Order-preserving projection of 128-bit values on 64 bits, for the chi2 tests
+uint64_t shift128(uint128_t N)
+{
+    uint64_t bits = Strategy128::bit_width(N);
+    return bits > 64 ? bits - 64 : 0;
+}
 
-    for (const StrategyType &strat : strategies)
+uint64_t test_no_repeat128(uint128_t N, uint128_t K, uint64_t runs, StrategyType st)
+{
+    uint64_t fails = 0;
+    for (uint64_t i = 0; i < runs; ++i)
     {
-        test_N_K_API(100 * 1000000, 1000000, runs, strat);
-        test_N_K_API(0xFFFFFFFFFFFFFFFFull, 100000, runs, strat);
-        test_N_K_API(1000000, 10000, runs, strat);
-        test_N_K_API(1000, 1000, runs, strat);
+        RNG128 generator(N, K, st, i);
+        uint64_t n = 0;
+        std::set<uint128_t> unique_numbers;
+        for (uint128_t i = 0; i < generator.getNumSamples(); i++)
+        {
+            uint128_t rand_num = generator.it();
+            if (rand_num > N)
+            {
+                printf("N FAILS (128): rand_num > N \n");
+                fails += 1;
+            }
+            unique_numbers.insert(rand_num);
+            n++;
+        }
+
+        if (unique_numbers.size() != generator.getNumSamples() or unique_numbers.size() != n)
+        {
+            printf("REPET. FAIL (128): %s N: %s K: %s \n", generator.GetName(), str128(N).c_str(), str128(K).c_str());
+            fails += 1;
+        }
     }
+    return fails;
 }
 
-void RANDOM_TEST(std::vector<StrategyType> &strategies)
+float test_operm5_128(const uint128_t N, const uint64_t K, const size_t runs, StrategyType st)
 {
-    // Test random seed behaviour:
-    // * Fixed random seed -> same series
-    // * Diff random seed -> chance to get different series
-    for (const StrategyType &strat : strategies)
+    float chi2_cumul = 0;
+    char *name;
+    const uint64_t shift = shift128(N);
+
+    for (uint64_t r = 0; r < runs; ++r)
     {
-        test_random_seed_effect(0xFFFFFFFFFFFFFFFFull, 3, 10, strat);
+        RNG128 generator{N, K, st, r};
+
+        std::vector<uint64_t> results_vector;
+        results_vector.reserve(K + 1);
+
+        for (size_t i = 0; i < K + 1; ++i)
+        {
+            results_vector.emplace_back((uint64_t)(generator.it() >> shift));
+        }
+
+        float chi2 = OPERM5Test(results_vector.data(), results_vector.size());
+        chi2_cumul += chi2;
+        name = (char *)generator.GetName();
     }
 
-    // OPERM5 test for each method, varying N and K
-    uint64_t b8 = 255;
-    uint64_t b16 = 65535;
-    uint64_t b32 = 4294967295;
-    uint64_t b64 = 0xFFFFFFFFFFFFFFFFull;
-    uint64_t runs = 10;
+    float score = chi2_cumul / runs;
+    printf("%s (128) K=%lu N=%s OPERM5=%.2f\n", name, K, str128(N).c_str(), score);
+    return score;
+}
 
-    for (const StrategyType &strat : strategies)
-    {
-        test_operm5(b8, b8, runs, strat);
+float test_uniform128(const uint128_t N, const uint64_t K, const size_t runs, StrategyType st)
+{
+    float stop_rate = 0.125; // We will evaluate if it is uniform only on 12.5% first values
+    double chi2_cumul = 0;
+    char *name;
+    const uint64_t shift = shift128(N);
 
-        test_operm5(b16, b8, runs, strat);
-        test_operm5(b16, b16, runs, strat);
+    for (uint64_t r = 0; r < runs; ++r)
+    {
+        RNG128 generator{N, K, st, r};
 
-        test_operm5(100 * 1000000, 1000000, 1, strat);
+        std::vector<uint64_t> results_vector;
+        results_vector.reserve(K + 1);
 
-        test_operm5(b32, b8, runs, strat);
-        test_operm5(b32, b16, runs, strat);
+        for (uint64_t i = 0; i < (uint64_t)(stop_rate * (K + 1)); ++i)
+        {
+            results_vector.emplace_back((uint64_t)(generator.it() >> shift));
+        }
 
-        test_operm5(0xFFFFFFFFFFFFFFFFull, b8, runs, strat);
-        test_operm5(0xFFFFFFFFFFFFFFFFull, b16, runs, strat);
+        double chi2 = uniform(results_vector, 0, (uint64_t)(N >> shift));
+        chi2_cumul += chi2;
+        name = (char *)generator.GetName();
     }
 
-    for (const StrategyType &strat : strategies)
-    {
-        test_uniform(b8, b8, runs, strat);
+    double score = chi2_cumul / runs;
+    printf("%s (128) K=%lu N=%s Uniform=%.4f\n", name, K, str128(N).c_str(), score);
+    return score;
+}
 
-        test_uniform(b16, b8, runs, strat);
-        test_uniform(b16, b16, runs, strat);
+uint64_t test_speed128(const uint128_t N, const uint64_t K, const size_t runs, StrategyType st)
+{
+    long cumul_t = 0;
 
-        test_uniform(100 * 1000000, 1000000, 1, strat);
+    RNG128 generator{N, K, st, 0};
+    const char *name = generator.GetName();
 
-        test_uniform(b32, b8, runs, strat);
-        test_uniform(b32, b16, runs, strat);
+    for (uint64_t r = 0; r < runs; ++r)
+    {
+        RNG128 generator{N, K, st, r};
+        uint128_t n;
+        auto t1 = std::chrono::system_clock::now();
 
-        test_uniform(0xFFFFFFFFFFFFFFFFull, b8, runs, strat);
-        test_uniform(0xFFFFFFFFFFFFFFFFull, b16, runs, strat);
+        for (uint64_t i = 0; i < K; ++i)
+        {
+            n = generator.it();
+        }
+        auto t2 = std::chrono::system_clock::now();
+        auto elapsed_time = std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count();
+
+        cumul_t += elapsed_time;
     }
+
+    uint64_t mean_ms = (cumul_t / runs) / 1000;
+    printf("TIME TEST: %s (128) N: %s K: %lu T(us): %lu\n", name, str128(N).c_str(), K, mean_ms);
+    return mean_ms;
 }
 
-int main(int argc, char *argv[])
+uint64_t test_reseed(uint64_t N, uint64_t K, uint64_t runs, StrategyType st)
 {
-    std::vector<StrategyType> strategies = {SUPER1, SUPER2, SUPER3, SUPER4};
-
-    printf("Short unit tests ... \n");
-    SHORT_UNIT_TEST(strategies);
-    printf("Big unit tests (takes several minutes)... \n");
-    BIG_UNIT_TEST(strategies);
-    printf("Random test score (takes several minutes) ... \n");
-    RANDOM_TEST(strategies);
+    // reseed() and reset() must give the same series as a new generator
+    uint64_t fails = 0;
+    RNG generator(N, K, st, 0);
+    for (uint64_t r = 0; r < runs; ++r)
+    {
+        uint64_t M = N / (r + 1);
+        uint64_t L = std::min(K, M);
+        RNG fresh_same_domain(N, K, st, r + 1);
+        RNG fresh_new_domain(M, L, st, r + 2);
 
-    // Time test
+        generator.reseed(r + 1);
+        for (uint64_t i = 0; i < generator.getNumSamples(); i++)
+        {
+            if (generator.it() != fresh_same_domain.it())
+            {
+                printf("RESEED FAIL: %s N: %lu K: %lu \n", generator.GetName(), N, K);
+                fails += 1;
+                break;
+            }
+        }
+
+        generator.reset(M, L, r + 2);
+        if (generator.getNumSamples() != fresh_new_domain.getNumSamples())
+        {
+            printf("RESET FAIL: %s N: %lu K: %lu \n", generator.GetName(), M, L);
+            fails += 1;
+        }
+        for (uint64_t i = 0; i < generator.getNumSamples(); i++)
+        {
+            if (generator.it() != fresh_new_domain.it())
+            {
+                printf("RESET FAIL: %s N: %lu K: %lu \n", generator.GetName(), M, L);
+                fails += 1;
+                break;
+            }
+        }
+        generator.reset(N, K, r); // back to the initial domain
+    }
+    return fails;
+}
+
+uint64_t test_capi(uint64_t N, uint64_t K, rngwr_strategy cst, StrategyType st)
+{
+    // The C API gives the same series as RNG, across fill(), skip() and serialization
+    uint64_t fails = 0;
+    const uint64_t seed = 7;
+    const uint64_t half = (K + 1) / 2;
+    RNG generator(N, K, st, seed);
+    rngwr_t *g = rngwr_create(N, K, cst, seed);
+
+    std::vector<uint64_t> expected(K + 1);
+    for (uint64_t i = 0; i <= K; i++)
+        expected[i] = generator.it();
+
+    std::vector<uint64_t> out(K + 1);
+    rngwr_fill(g, out.data(), half);
+
+    std::vector<char> state(rngwr_serialize(g, nullptr, 0));
+    rngwr_serialize(g, state.data(), state.size());
+    rngwr_t *restored = rngwr_deserialize(state.data(), state.size());
+    rngwr_fill(g, out.data() + half, K + 1 - half);
+    if (out != expected)
+    {
+        printf("C API FILL FAIL: %s N: %lu K: %lu \n", rngwr_name(g), N, K);
+        fails += 1;
+    }
+    if (rngwr_fill(g, out.data(), 1) != 0)
+    {
+        printf("C API FILL FAIL: %s N: %lu K: %lu, a value beyond the K+1 samples \n", rngwr_name(g), N, K);
+        fails += 1;
+    }
+
+    // Only the K+1 samples are written
+    rngwr_t *narrow = rngwr_create(N, K, cst, seed);
+    std::vector<uint32_t> out32(K + 2);
+    uint64_t written = rngwr_fill_u32(narrow, out32.data(), K + 2);
+    if (written != (N <= 0xFFFFFFFFull ? K + 1 : 0) ||
+        (written != 0 && !std::equal(out32.begin(), out32.begin() + K + 1, expected.begin())))
+    {
+        printf("C API FILL U32 FAIL: %s N: %lu K: %lu \n", rngwr_name(g), N, K);
+        fails += 1;
+    }
+    rngwr_destroy(narrow);
+
+    rngwr_skip(restored, K / 4);
+    uint64_t v;
+    rngwr_fill(restored, &v, 1);
+    if (restored == nullptr || v != expected[half + K / 4])
+    {
+        printf("C API SERIALIZE/SKIP FAIL: %s N: %lu K: %lu \n", rngwr_name(g), N, K);
+        fails += 1;
+    }
+
+    rngwr_destroy(restored);
+    rngwr_destroy(g);
+    return fails;
+}
+
+uint64_t test_capi_restore(uint64_t values, rngwr_strategy cst)
+{
+    // With K << N each value draws from the Mersenne Twister: its state is serialized, thus the time of
+    // rngwr_deserialize() does not grow with the values produced
+    uint64_t fails = 0;
+    const uint64_t N = 0xFFFFFFFFFFFFFFFFull;
+    rngwr_t *g = rngwr_create(N, 1ull << 40, cst, 11);
+    std::vector<uint64_t> out(1 << 16);
+    for (uint64_t done = 0; done < values; done += out.size())
+        rngwr_fill(g, out.data(), std::min((uint64_t)out.size(), values - done));
+
+    std::vector<char> state(rngwr_serialize(g, nullptr, 0));
+    rngwr_serialize(g, state.data(), state.size());
+    auto t1 = std::chrono::steady_clock::now();
+    rngwr_t *restored = rngwr_deserialize(state.data(), state.size());
+    auto t2 = std::chrono::steady_clock::now();
+    double us = std::chrono::duration<double, std::micro>(t2 - t1).count();
+
+    std::vector<uint64_t> expected(1000), continued(1000);
+    rngwr_fill(g, expected.data(), expected.size());
+    if (restored == nullptr || rngwr_fill(restored, continued.data(), continued.size()) != continued.size() ||
+        continued != expected || us > 1000)
+    {
+        printf("C API RESTORE FAIL: %s values: %lu deserialize(us): %.1f \n", rngwr_name(g), values, us);
+        fails += 1;
+    }
+    printf("TIME TEST: C API %s restore after %lu values T(us): %.1f\n", rngwr_name(g), values, us);
+    rngwr_destroy(restored);
+    rngwr_destroy(g);
+    return fails;
+}
+
+uint64_t test_prefetch(uint64_t N, uint64_t K, uint64_t ring_size, uint64_t low_water, StrategyType st)
+{
+    // Same series as RNG, including when the producer is blocked by a full ring
+    uint64_t fails = 0;
+    RNG generator(N, K, st, 3);
+    {
+        PrefetchRNG prefetch(N, K, st, 3, ring_size, low_water);
+        for (uint64_t i = 0; i < prefetch.getNumSamples(); i++)
+        {
+            uint64_t value;
+            if (!prefetch.it(value) || value != generator.it())
+            {
+                printf("PREFETCH FAIL: %s N: %lu K: %lu ring: %lu \n", prefetch.GetName(), N, K, ring_size);
+                fails += 1;
+                break;
+            }
+        }
+        // Only the K+1 samples are produced, even when the ring has room for more
+        uint64_t value;
+        if (K < 0xFFFFFFFFFFFFFFFFull && (prefetch.it(value) || prefetch.try_it(value) || !prefetch.exhausted()))
+        {
+            printf("PREFETCH FAIL: %s N: %lu K: %lu ring: %lu, a value beyond the K+1 samples \n", prefetch.GetName(),
+                   N, K, ring_size);
+            fails += 1;
+        }
+    }
+
+    // Clean shutdown with a full ring and a sleeping producer
+    PrefetchRNG prefetch(N, K, st, 3, ring_size, low_water);
+    while (prefetch.getReady() < std::min(prefetch.getRingSize(), prefetch.getNumSamples()))
+        std::this_thread::yield();
+    uint64_t value;
+    prefetch.it(value);
+    prefetch.stop();
+
+    // After stop() the ready values are given, then it() fails instead of waiting
+    uint64_t given = 0;
+    while (prefetch.it(value))
+        given++;
+    if (given + 1 > prefetch.getNumSamples() || !prefetch.exhausted())
+    {
+        printf("PREFETCH STOP FAIL: %s N: %lu K: %lu ring: %lu \n", prefetch.GetName(), N, K, ring_size);
+        fails += 1;
+    }
+    return fails;
+}
+
+uint64_t test_family_no_repeat(uint64_t N, uint64_t streams, StrategyType st)
+{
+    // Each stream is a permutation of [0,N] and two streams give different series
+    uint64_t fails = 0;
+    PermutationFamily family(N, st, 11);
+    std::vector<uint64_t> previous;
+    for (uint64_t t = 0; t < streams; t++)
+    {
+        uint64_t counter = 0;
+        std::set<uint64_t> unique_numbers;
+        std::vector<uint64_t> series;
+        for (uint64_t j = 0; j < family.getNumSamples(); j++)
+        {
+            uint64_t v = family.it(t * 0x9E3779B97F4A7C15ull, counter);
+            if (v > N)
+                fails += 1;
+            unique_numbers.insert(v);
+            series.push_back(v);
+        }
+        if (unique_numbers.size() != family.getNumSamples() || counter != family.getNumSamples())
+        {
+            printf("FAMILY REPET. FAIL: %s N: %lu stream: %lu \n", family.GetName(), N, t);
+            fails += 1;
+        }
+        if (N > 8 && series == previous)
+        {
+            printf("FAMILY STREAM FAIL: %s N: %lu stream: %lu same as previous \n", family.GetName(), N, t);
+            fails += 1;
+        }
+        previous = series;
+    }
+    return fails;
+}
+
+uint64_t test_grid_no_repeat(const std::vector<uint64_t> &extents, uint64_t K, uint64_t runs)
+{
+    // Unique cells inside the grid, and the same series from it() and from the batch fill()
+    uint64_t fails = 0;
+    const uint64_t d = extents.size();
+    for (uint64_t r = 0; r < runs; r++)
+    {
+        GridSampler grid(extents, K, r);
+        GridSampler batch(extents, K, r);
+        std::vector<std::vector<uint64_t>> columns(d, std::vector<uint64_t>(grid.getNumSamples()));
+        std::vector<uint64_t *> ptrs(d);
+        for (uint64_t j = 0; j < d; j++)
+            ptrs[j] = columns[j].data();
+        uint64_t written = 0;
+        while (written < grid.getNumSamples())
+        {
+            std::vector<uint64_t *> at(d);
+            for (uint64_t j = 0; j < d; j++)
+                at[j] = ptrs[j] + written;
+            written += batch.fill(at.data(), 7);
+        }
+
+        std::set<std::vector<uint64_t>> cells;
+        std::vector<uint64_t> c(d);
+        for (uint64_t t = 0; t < grid.getNumSamples(); t++)
+        {
+            grid.it(c.data());
+            for (uint64_t j = 0; j < d; j++)
+            {
+                if (c[j] >= extents[j] || c[j] != columns[j][t])
+                {
+                    printf("GRID FAIL: cell %lu dim %lu: %lu (extent %lu, batch %lu)\n", t, j, c[j], extents[j],
+                           columns[j][t]);
+                    fails += 1;
+                    return fails;
+                }
+            }
+            cells.insert(c);
+        }
+        if (cells.size() != grid.getNumSamples())
+        {
+            printf("GRID REPET. FAIL: %s dims: %lu K: %lu \n", grid.GetName(), d, K);
+            fails += 1;
+        }
+    }
+    return fails;
+}
+
+float test_grid_quality(const std::vector<uint64_t> &extents, uint64_t K, uint64_t runs)
+{
+    // OPERM5 and uniform tests on the row-major index of the cells
+    double operm = 0, unif = 0;
+    uint64_t cells = 1;
+    for (uint64_t e : extents)
+        cells *= e;
+    for (uint64_t r = 0; r < runs; r++)
+    {
+        GridSampler grid(extents, K, r);
+        std::vector<uint64_t> c(extents.size());
+        std::vector<uint64_t> flat;
+        for (uint64_t t = 0; t < grid.getNumSamples(); t++)
+        {
+            grid.it(c.data());
+            uint64_t f = 0;
+            for (uint64_t j = 0; j < extents.size(); j++)
+                f = f * extents[j] + c[j];
+            flat.push_back(f);
+        }
+        operm += OPERM5Test(flat.data(), flat.size());
+        flat.resize(flat.size() / 8); // Same 12.5% as test_uniform
+        unif += uniform(flat, 0, cells - 1);
+    }
+    printf("Grid dims=%lu cells=%lu K=%lu OPERM5=%.2f Uniform=%.4f\n", extents.size(), cells, K, operm / runs,
+           unif / runs);
+    return operm / runs;
+}
+
+void test_grid_speed(const std::vector<uint64_t> &extents, uint64_t K, StrategyType st)
+{
+    // Grid cells compared to a flat RNG on the product of the extents, decoded with a divide and a
+    // modulo per coordinate
+    const uint64_t d = extents.size();
+    const uint64_t batch = 1024;
+    uint64_t cells = 1;
+    for (uint64_t e : extents)
+        cells *= e;
+    std::vector<std::vector<uint64_t>> columns(d, std::vector<uint64_t>(batch));
+    std::vector<uint64_t *> ptrs(d);
+    for (uint64_t j = 0; j < d; j++)
+        ptrs[j] = columns[j].data();
+    uint64_t check = 0;
+
+    GridSampler grid(extents, K, 1);
+    auto t1 = std::chrono::steady_clock::now();
+    for (uint64_t done = 0; done < grid.getNumSamples();)
+    {
+        uint64_t n = grid.fill(ptrs.data(), batch);
+        for (uint64_t j = 0; j < d; j++)
+            check += columns[j][n - 1];
+        done += n;
+    }
+    auto t2 = std::chrono::steady_clock::now();
+
+    RNG flat(cells - 1, K, st, 1);
+    for (uint64_t done = 0; done < flat.getNumSamples();)
+    {
+        uint64_t n = std::min(batch, flat.getNumSamples() - done);
+        for (uint64_t t = 0; t < n; t++)
+        {
+            uint64_t f = flat.it();
+            for (uint64_t j = d; j-- > 0;)
+            {
+                columns[j][t] = f % extents[j];
+                f /= extents[j];
+            }
+        }
+        for (uint64_t j = 0; j < d; j++)
+            check += columns[j][n - 1];
+        done += n;
+    }
+    auto t3 = std::chrono::steady_clock::now();
+
+    double ns_grid = std::chrono::duration<double, std::nano>(t2 - t1).count() / grid.getNumSamples();
+    double ns_flat = std::chrono::duration<double, std::nano>(t3 - t2).count() / flat.getNumSamples();
+    printf("GRID TEST: dims: %lu cells: %lu K: %lu grid(ns/cell): %.1f %s flat+divmod(ns/cell): %.1f (%lu)\n", d,
+           cells, K, ns_grid, flat.GetName(), ns_flat, check & 1);
+}
+
+uint64_t test_batch_no_repeat(uint64_t N, uint64_t K, uint64_t generators, StrategyType st)
+{
+    // Every generator gives K+1 unique values, and the same series whichever subset is advanced with it
+    uint64_t fails = 0;
+    std::vector<uint64_t> seeds(generators);
+    for (uint64_t g = 0; g < generators; g++)
+        seeds[g] = 1000 + g;
+    BatchRNG all(N, K, st, seeds);
+    BatchRNG subsets(N, K, st, seeds);
+
+    std::vector<std::vector<uint64_t>> series(generators), series_subsets(generators);
+    std::vector<uint64_t> out(generators);
+    for (uint64_t j = 0; j < all.getNumSamples(); j++)
+    {
+        all.next_all(out.data());
+        for (uint64_t g = 0; g < generators; g++)
+            series[g].push_back(out[g]);
+    }
+
+    std::mt19937_64 pick(7);
+    std::vector<uint32_t> ids;
+    std::vector<uint64_t> done(generators, 0);
+    for (bool left = true; left;)
+    {
+        ids.clear();
+        left = false;
+        for (uint32_t g = 0; g < generators; g++)
+            if (done[g] < subsets.getNumSamples())
+            {
+                left = true;
+                if (pick() % 3 == 0)
+                    ids.push_back(g);
+            }
+        subsets.next(ids.data(), ids.size(), out.data());
+        for (uint64_t t = 0; t < ids.size(); t++)
+        {
+            series_subsets[ids[t]].push_back(out[t]);
+            done[ids[t]]++;
+        }
+    }
+
+    for (uint64_t g = 0; g < generators; g++)
+    {
+        std::set<uint64_t> unique_numbers(series[g].begin(), series[g].end());
+        bool in_range = std::all_of(series[g].begin(), series[g].end(), [N](uint64_t v) { return v <= N; });
+        if (unique_numbers.size() != all.getNumSamples() || !in_range)
+        {
+            printf("BATCH REPET. FAIL: %s N: %lu K: %lu generator: %lu \n", all.GetName(), N, K, g);
+            fails += 1;
+        }
+        if (series[g] != series_subsets[g])
+        {
+            printf("BATCH SUBSET FAIL: %s N: %lu K: %lu generator: %lu \n", all.GetName(), N, K, g);
+            fails += 1;
+        }
+    }
+
+    // After the K+1 samples the values stay in [0,N], with K = N the permutation starts again
+    for (uint64_t j = 0; j < all.getNumSamples(); j++)
+    {
+        all.next_all(out.data());
+        for (uint64_t g = 0; g < generators; g++)
+        {
+            if (out[g] > N || (K == N && out[g] != series[g][j]))
+            {
+                printf("BATCH PAST THE END FAIL: %s N: %lu K: %lu generator: %lu \n", all.GetName(), N, K, g);
+                return fails + 1;
+            }
+        }
+    }
+    return fails;
+}
+
+float test_batch_operm5(uint64_t N, uint64_t K, uint64_t generators, StrategyType st)
+{
+    // OPERM5 on the series of a few generators of the batch
+    std::vector<uint64_t> seeds(generators);
+    for (uint64_t g = 0; g < generators; g++)
+        seeds[g] = g;
+    BatchRNG batch(N, K, st, seeds);
+    std::vector<std::vector<uint64_t>> series(generators);
+    std::vector<uint64_t> out(generators);
+    for (uint64_t j = 0; j < batch.getNumSamples(); j++)
+    {
+        batch.next_all(out.data());
+        for (uint64_t g = 0; g < generators; g++)
+            series[g].push_back(out[g]);
+    }
+    float score = 0;
+    for (uint64_t g = 0; g < generators; g++)
+        score += OPERM5Test(series[g].data(), series[g].size());
+    score /= generators;
+    printf("%s K=%lu N=%lu generators=%lu OPERM5=%.2f\n", batch.GetName(), K, N, generators, score);
+    return score;
+}
+
+void test_batch_speed(uint64_t N, uint64_t generators, uint64_t selected, uint64_t calls, StrategyType st)
+{
+    // One next() per request on 'selected' generators among 'generators', against it() on RNG objects
+    std::vector<uint64_t> seeds(generators);
+    for (uint64_t g = 0; g < generators; g++)
+        seeds[g] = g;
+    BatchRNG batch(N, N, st, seeds);
+    std::vector<RNG *> objects;
+    for (uint64_t g = 0; g < generators; g++)
+        objects.push_back(new RNG(N, N, st, g));
+
+    std::mt19937_64 pick(3);
+    std::vector<std::vector<uint32_t>> requests(calls, std::vector<uint32_t>(selected));
+    for (auto &ids : requests)
+        for (auto &id : ids)
+            id = pick() % generators;
+    for (auto &ids : requests) // Distinct ids per request
+    {
+        std::sort(ids.begin(), ids.end());
+        ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    }
+
+    std::vector<uint64_t> out(selected);
+    uint64_t values = 0, check = 0;
+    auto t1 = std::chrono::steady_clock::now();
+    for (auto &ids : requests)
+    {
+        batch.next(ids.data(), ids.size(), out.data());
+        check += out[0];
+        values += ids.size();
+    }
+    auto t2 = std::chrono::steady_clock::now();
+    for (auto &ids : requests)
+    {
+        for (uint64_t t = 0; t < ids.size(); t++)
+            out[t] = objects[ids[t]]->it();
+        check += out[0];
+    }
+    auto t3 = std::chrono::steady_clock::now();
+
+    double ns_batch = std::chrono::duration<double, std::nano>(t2 - t1).count() / values;
+    double ns_objects = std::chrono::duration<double, std::nano>(t3 - t2).count() / values;
+    printf("BATCH TEST: %s N: %lu generators: %lu per call: %lu batch(ns/value): %.1f RNG objects(ns/value): %.1f "
+           "state bytes per generator: %lu vs %lu\n",
+           batch.GetName(), N, generators, selected, ns_batch, ns_objects, (3 + 2 * 6) * sizeof(uint64_t),
+           sizeof(RNG) + sizeof(Super_rng));
+    printf("BATCH TEST: checksum of the values: %lu\n", check); // Keeps the loops from being optimized out
+    for (RNG *r : objects)
+        delete r;
+}
+
+struct Record24
+{
+    uint64_t key;
+    uint64_t payload[2];
+    bool operator==(const Record24 &o) const { return key == o.key && payload[0] == o.payload[0] && payload[1] == o.payload[1]; }
+};
+
+template <typename T>
+uint64_t test_apply_permutation(uint64_t N, uint64_t K, uint64_t threads, StrategyType st)
+{
+    // Same records as the naive gather dst[j] = src[it()], and shuffle() is a permutation of the records
+    uint64_t fails = 0;
+    std::vector<T> src(N + 1), dst(K + 1), expected(K + 1);
+    for (uint64_t j = 0; j <= N; j++)
+    {
+        src[j] = T();
+        *(uint64_t *)&src[j] = j * 0x9E3779B97F4A7C15ull;
+    }
+
+    RNG naive(N, K, st, 11);
+    for (uint64_t j = 0; j <= K; j++)
+        expected[j] = src[naive.it()];
+    RNG blocked(N, K, st, 11);
+    blocked.apply_permutation(src.data(), src.size(), dst.data(), dst.size(), threads);
+    if (!(dst == expected))
+    {
+        printf("APPLY PERMUTATION FAIL: %s N: %lu K: %lu record: %lu threads: %lu \n", blocked.GetName(), N, K,
+               sizeof(T), threads);
+        fails += 1;
+    }
+
+    if (K == N)
+    {
+        RNG shuffler(N, N, st, 11);
+        shuffler.shuffle(src.data(), src.size(), threads);
+        if (!(src == expected))
+        {
+            printf("SHUFFLE FAIL: %s N: %lu record: %lu threads: %lu \n", shuffler.GetName(), N, sizeof(T), threads);
+            fails += 1;
+        }
+    }
+    return fails;
+}
+
+void test_shuffle_speed(uint64_t bytes, StrategyType st)
+{
+    // Shuffle of 8-byte records: naive gather, std::shuffle, cache-blocked apply_permutation()
+    const uint64_t n = bytes / sizeof(uint64_t);
+    std::vector<uint64_t> src(n), dst(n);
+    std::iota(src.begin(), src.end(), 0);
+    const char *name;
+
+    auto t1 = std::chrono::steady_clock::now();
+    {
+        RNG generator(n - 1, n - 1, st, 5);
+        name = generator.GetName();
+        for (uint64_t j = 0; j < n; j++)
+            dst[j] = src[generator.it()];
+    }
+    auto t2 = std::chrono::steady_clock::now();
+    {
+        std::mt19937_64 g(5);
+        std::shuffle(dst.begin(), dst.end(), g);
+    }
+    auto t3 = std::chrono::steady_clock::now();
+    {
+        RNG generator(n - 1, n - 1, st, 5);
+        generator.apply_permutation(src.data(), n, dst.data(), n, 1);
+    }
+    auto t4 = std::chrono::steady_clock::now();
+    uint64_t threads = std::max(1u, std::thread::hardware_concurrency());
+    {
+        RNG generator(n - 1, n - 1, st, 5);
+        generator.apply_permutation(src.data(), n, dst.data(), n, threads);
+    }
+    auto t5 = std::chrono::steady_clock::now();
+
+    auto ns = [n](std::chrono::steady_clock::time_point a, std::chrono::steady_clock::time_point b)
+    { return std::chrono::duration<double, std::nano>(b - a).count() / n; };
+    printf("SHUFFLE TEST: %s MB: %lu naive gather(ns/record): %.1f std::shuffle: %.1f blocked: %.1f blocked %lu threads: %.1f\n",
+           name, bytes >> 20, ns(t1, t2), ns(t2, t3), ns(t3, t4), threads, ns(t4, t5));
+}
+
+uint64_t test_locality(uint64_t N, uint64_t K, uint64_t block_size, uint64_t depth, StrategyType st)
+{
+    // K+1 unique values in [0,N], taken from at most 'depth' blocks at a time
+    uint64_t fails = 0;
+    LocalityRNG generator(N, K, block_size, depth, st, 3);
+    std::set<uint64_t> unique_numbers;
+    std::set<uint64_t> window;
+    uint64_t bs = generator.getBlockSize();
+    for (uint64_t j = 0; j < generator.getNumSamples(); j++)
+    {
+        uint64_t v = generator.it();
+        if (v > N)
+        {
+            printf("LOCALITY FAIL: %s N: %lu value %lu > N \n", generator.GetName(), N, v);
+            fails += 1;
+            break;
+        }
+        unique_numbers.insert(v);
+        // Blocks are done in order of opening, thus depth consecutive values come from <= depth+1 blocks
+        window.insert(v / bs);
+        if ((j + 1) % depth == 0)
+        {
+            if (window.size() > depth + 1)
+            {
+                printf("LOCALITY FAIL: %s N: %lu block: %lu depth: %lu, %lu blocks in a window \n", generator.GetName(),
+                       N, block_size, depth, window.size());
+                fails += 1;
+                break;
+            }
+            window.clear();
+        }
+    }
+    if (unique_numbers.size() != generator.getNumSamples())
+    {
+        printf("LOCALITY REPET. FAIL: %s N: %lu K: %lu block: %lu depth: %lu \n", generator.GetName(), N, K, block_size,
+               depth);
+        fails += 1;
+    }
+    return fails;
+}
+
+void test_locality_mmap(uint64_t bytes, StrategyType st)
+{
+    // Reads every 8-byte record of a memory-mapped file once, in the order of the generator.
+    // A fresh mapping per run, the file stays in the page cache. Each mode faults every page in once,
+    // the pages touched per window of reads is what differs between them.
+    const uint64_t n = bytes / sizeof(uint64_t);
+    char path[] = "/tmp/rngwr_locality_XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0)
+    {
+        printf("LOCALITY MMAP: can not create a file in /tmp\n");
+        return;
+    }
+    unlink(path);
+    std::vector<uint64_t> buffer(1 << 16);
+    for (uint64_t j = 0; j < n; j += buffer.size())
+    {
+        uint64_t c = std::min((uint64_t)buffer.size(), n - j);
+        std::iota(buffer.begin(), buffer.begin() + c, j);
+        if (write(fd, buffer.data(), c * sizeof(uint64_t)) != (ssize_t)(c * sizeof(uint64_t)))
+        {
+            printf("LOCALITY MMAP: write failed\n");
+            close(fd);
+            return;
+        }
+    }
+
+    // Pages (512 records) touched per window of 4096 reads, the working set of the order
+    auto pages_per_window = [&](auto &&next)
+    {
+        const uint64_t window = 4096;
+        std::vector<uint64_t> pages(window);
+        uint64_t total = 0;
+        for (uint64_t j = 0; j + window <= n; j += window)
+        {
+            for (uint64_t t = 0; t < window; t++)
+                pages[t] = next() >> 9;
+            std::sort(pages.begin(), pages.end());
+            total += std::unique(pages.begin(), pages.end()) - pages.begin();
+        }
+        return (double)total / (n / window);
+    };
+
+    auto run = [&](const char *name, uint64_t block, uint64_t depth, auto &&next, double pages)
+    {
+        const uint64_t *data = (const uint64_t *)mmap(nullptr, n * sizeof(uint64_t), PROT_READ, MAP_PRIVATE, fd, 0);
+        madvise((void *)data, n * sizeof(uint64_t), MADV_RANDOM);
+        uint64_t sum = 0;
+        auto t1 = std::chrono::steady_clock::now();
+        for (uint64_t j = 0; j < n; j++)
+            sum += data[next()];
+        auto t2 = std::chrono::steady_clock::now();
+        munmap((void *)data, n * sizeof(uint64_t));
+        bool ok = sum == (n - 1) * n / 2;
+        printf("LOCALITY TEST: %s MB: %lu block(records): %lu depth: %lu ns/read: %.1f pages/4096 reads: %.1f%s\n",
+               name, bytes >> 20, block, depth, std::chrono::duration<double, std::nano>(t2 - t1).count() / n,
+               pages, ok ? "" : " FAIL: sum");
+    };
+
+    {
+        RNG counter(n - 1, n - 1, st, 1);
+        double pages = pages_per_window([&]() { return counter.it(); });
+        RNG generator(n - 1, n - 1, st, 1);
+        run(generator.GetName(), 1, 1, [&]() { return generator.it(); }, pages);
+    }
+    for (uint64_t block : {512ull, 262144ull}) // 4 KB and 2 MB of records
+    {
+        for (uint64_t depth : {1ull, 8ull, 64ull})
+        {
+            LocalityRNG counter(n - 1, n - 1, block, depth, st, 1);
+            double pages = pages_per_window([&]() { return counter.it(); });
+            LocalityRNG generator(n - 1, n - 1, block, depth, st, 1);
+            run(generator.GetName(), block, depth, [&]() { return generator.it(); }, pages);
+        }
+    }
+    close(fd);
+}
+
+uint64_t test_growing(uint64_t N, const vector<uint64_t> &steps, StrategyType st)
+{
+    // steps: values drawn, then the domain grows by the next step, and so on. The rest is drawn at the end.
+    uint64_t fails = 0;
+    GrowingRNG generator(N, st, 5);
+    std::set<uint64_t> unique_numbers;
+    uint64_t count = 0;
+    auto draw = [&](uint64_t n)
+    {
+        for (uint64_t j = 0; j < n; j++)
+        {
+            uint64_t v = generator.it();
+            if (v > generator.getMaxValue())
+                fails += 1;
+            unique_numbers.insert(v);
+            count++;
+        }
+    };
+    for (uint64_t t = 0; t + 1 < steps.size(); t += 2)
+    {
+        draw(std::min(steps[t], generator.getRemaining()));
+        generator.extend_domain(generator.getMaxValue() + steps[t + 1]);
+    }
+    draw(generator.getRemaining());
+    if (fails != 0 || unique_numbers.size() != count || count != generator.getMaxValue() + 1 || generator.getNumSegments() != 0)
+    {
+        printf("GROWING FAIL: %s N: %lu, %lu values for %lu unique, %lu segments left \n", generator.GetName(),
+               generator.getMaxValue(), count, unique_numbers.size(), generator.getNumSegments());
+        fails += 1;
+    }
+
+    // A new pass over the grown domain
+    unique_numbers.clear();
+    count = 0;
+    draw(generator.getMaxValue() + 1);
+    if (unique_numbers.size() != count || generator.getRemaining() != 0)
+    {
+        printf("GROWING NEW PASS FAIL: %s N: %lu \n", generator.GetName(), generator.getMaxValue());
+        fails += 1;
+    }
+    return fails;
+}
+
+uint64_t test_growing_uniform(StrategyType st)
+{
+    // 500 of [0,999] drawn, then [1000,1999] appended: 2/3 of the values left are new
+    uint64_t fails = 0;
+    uint64_t news = 0;
+    const uint64_t runs = 100;
+    for (uint64_t seed = 0; seed < runs; seed++)
+    {
+        GrowingRNG generator(999, st, seed);
+        for (uint64_t j = 0; j < 500; j++)
+            generator.it();
+        generator.extend_domain(1999);
+        for (uint64_t j = 0; j < 300; j++)
+            news += generator.it() >= 1000;
+    }
+    double ratio = (double)news / (runs * 300);
+    if (ratio < 0.64 || ratio > 0.69)
+    {
+        printf("GROWING UNIFORM FAIL: level %lu ratio of new values %f instead of 0.667 \n", SuperLevel(st), ratio);
+        fails += 1;
+    }
+    return fails;
+}
+
+void test_growing_speed(uint64_t segments, uint64_t per_segment, StrategyType st)
+{
+    // One extension every per_segment values, half of them drawn before the next one
+    GrowingRNG generator(per_segment - 1, st, 1);
+    uint64_t sum = 0, count = 0;
+    auto t1 = std::chrono::steady_clock::now();
+    for (uint64_t s = 1; s < segments; s++)
+    {
+        for (uint64_t j = 0; j < per_segment / 2; j++)
+            sum += generator.it();
+        count += per_segment / 2;
+        generator.extend_domain(generator.getMaxValue() + per_segment);
+    }
+    while (generator.getRemaining() != 0)
+    {
+        sum += generator.it();
+        count++;
+    }
+    auto t2 = std::chrono::steady_clock::now();
+    printf("TIME TEST: %s segments: %lu values: %lu ns/value: %.1f (%lu)\n", generator.GetName(), segments, count,
+           std::chrono::duration<double, std::nano>(t2 - t1).count() / count, sum & 1);
+}
+
+template <typename W>
+uint64_t test_unpermute(W N, StrategyType st)
+{
+    // unpermute(permute(x)) = x over the whole word of the permutation
+    uint64_t fails = 0;
+    Super_rng_t<W> generator(N, N, SuperLevel(st), 11);
+    const uint64_t bits = generator.getDomainBits();
+    const W mask = (bits < sizeof(W) * 8) ? ((W)1 << bits) - 1 : ~(W)0;
+    for (uint64_t j = 0; j < 10000; j++)
+    {
+        W x = ((W)Strategy::splitmix64(j) << 32 << 32 | (W)Strategy::splitmix64(~j)) & mask;
+        if (generator.unpermute(generator.permute(x)) != x || generator.permute(generator.unpermute(x)) != x)
+        {
+            printf("UNPERMUTE FAIL: %s bits: %lu \n", generator.GetName(), bits);
+            fails += 1;
+            break;
+        }
+    }
+    return fails;
+}
+
+uint64_t test_round_table(uint64_t N, StrategyType st)
+{
+    // The rounds of the tables against the computed ones for the same seed, value by value, and against
+    // the computed inverse
+    uint64_t fails = 0;
+    const uint64_t level = SuperLevel(st);
+    Super_rng generator(N, N, level, 17);
+    Super_rng computed(N, N, level, 17);
+    computed.useTables(false);
+    const uint64_t bits = generator.getDomainBits();
+    // Round table up to 2^16 words (SUPER2 needs N+1 >= 2^bits / 2), two node tables up to 2^32
+    const bool expected = (level == 3 || level == 4 || (level == 2 && bits > 16)) && bits <= 32;
+    const uint64_t bytes = (bits <= 16) ? (2ull << bits) : (4ull << (bits / 2));
+    if ((expected && generator.getTableBytes() != bytes) || computed.getTableBytes() != 0)
+    {
+        printf("ROUND TABLE FAIL: %s N: %lu table: %lu bytes \n", generator.GetName(), N, generator.getTableBytes());
+        fails += 1;
+    }
+    const uint64_t step = std::max((uint64_t)1, (uint64_t)((1ull << bits) >> 16));
+    for (uint64_t x = 0; x < (1ull << bits); x += step)
+    {
+        const uint64_t y = generator.permute(x);
+        if (y != computed.permute(x) || generator.unpermute(y) != x)
+        {
+            printf("ROUND TABLE FAIL: %s N: %lu permute(%lu) \n", generator.GetName(), N, x);
+            return fails + 1;
+        }
+    }
+
+    // reseed() defers the tables until the draws pay for them: the same values before and after
+    Super_rng reseeded(N, N, level, 3);
+    reseeded.reseed(17);
+    bool same = reseeded.getTableBytes() == 0;
+    const uint64_t draws = std::min(N, (uint64_t)1 << 16) + 1;
+    for (uint64_t j = 0; j < draws && same; j++)
+        same = reseeded.it() == generator.it();
+    if (!same || reseeded.getTableBytes() != generator.getTableBytes())
+    {
+        printf("ROUND TABLE RESEED FAIL: %s N: %lu table: %lu bytes \n", generator.GetName(), N, reseeded.getTableBytes());
+        fails += 1;
+    }
+    return fails;
+}
+
+void test_round_table_speed(uint64_t N, StrategyType st)
+{
+    // Construction with the tables (K = N) and without (K = 0), permute() from the tables and computed
+    // on 2^16 words at most, then a pass of at most 2^20 values
+    const uint64_t level = SuperLevel(st);
+    const uint64_t runs = 20;
+    uint64_t sum = 0;
+    auto t1 = std::chrono::steady_clock::now();
+    for (uint64_t r = 0; r < runs; r++)
+        sum += Super_rng(N, N, level, r).it();
+    auto t2 = std::chrono::steady_clock::now();
+    for (uint64_t r = 0; r < runs; r++)
+        sum += Super_rng(N, 0, level, r).it();
+    auto t3 = std::chrono::steady_clock::now();
+
+    Super_rng table(N, N, level, 1);
+    Super_rng computed(N, N, level, 1);
+    computed.useTables(false);
+    const uint64_t step = std::max((uint64_t)1, (uint64_t)((1ull << table.getDomainBits()) >> 16));
+    const uint64_t size = (1ull << table.getDomainBits()) / step;
+    auto t4 = std::chrono::steady_clock::now();
+    for (uint64_t x = 0; x < size; x++)
+        sum += table.permute(x * step);
+    auto t5 = std::chrono::steady_clock::now();
+    for (uint64_t x = 0; x < size; x++)
+        sum += computed.permute(x * step);
+    auto t6 = std::chrono::steady_clock::now();
+    std::vector<uint64_t> out(std::min(N + 1, (uint64_t)1 << 20));
+    table.fill(out.data(), out.size());
+    auto t7 = std::chrono::steady_clock::now();
+
+    printf("TIME TEST: %s N: %lu table: %lu bytes new(us): %.1f (computed: %.1f) ns/permute(): %.1f (computed: %.1f) "
+           "ns/value (fill): %.1f (%lu)\n",
+           table.GetName(), N, table.getTableBytes(), std::chrono::duration<double, std::micro>(t2 - t1).count() / runs,
+           std::chrono::duration<double, std::micro>(t3 - t2).count() / runs,
+           std::chrono::duration<double, std::nano>(t5 - t4).count() / size,
+           std::chrono::duration<double, std::nano>(t6 - t5).count() / size,
+           std::chrono::duration<double, std::nano>(t7 - t6).count() / out.size(), (sum + out[0]) & 1);
+}
+
+uint64_t test_split(uint64_t N, const vector<uint64_t> &sizes, StrategyType st)
+{
+    // Members in permutation order and sorted, against the partition() of each value and the it() series
+    uint64_t fails = 0;
+    RandomSplit split(N, sizes, st, 7);
+    Super_rng series(N, N, SuperLevel(st), 7, true);
+    std::vector<uint64_t> owner(N + 1, ~0ull);
+    for (uint64_t p = 0; p < split.getNumPartitions(); p++)
+    {
+        std::vector<uint64_t> members(split.getSize(p));
+        split.fill(p, 0, members.data(), members.size());
+        for (uint64_t j = 0; j < members.size(); j++)
+        {
+            uint64_t x = members[j];
+            if (x > N || owner[x] != ~0ull || x != series.it() || split.partition(x) != p ||
+                split.position(x) != split.getStart(p) + j || split.member(p, j) != x)
+            {
+                printf("SPLIT FAIL: %s N: %lu partition %lu member %lu \n", split.GetName(), N, p, j);
+                return fails + 1;
+            }
+            owner[x] = p;
+        }
+
+        std::sort(members.begin(), members.end());
+        uint64_t j = 0;
+        for (uint64_t x = split.next_sorted(p, 0); x <= N; x = split.next_sorted(p, x + 1))
+        {
+            if (j >= members.size() || members[j] != x)
+            {
+                printf("SPLIT SORTED FAIL: %s N: %lu partition %lu member %lu \n", split.GetName(), N, p, j);
+                return fails + 1;
+            }
+            j++;
+        }
+        if (j != members.size())
+        {
+            printf("SPLIT SORTED FAIL: %s N: %lu partition %lu, %lu members instead of %lu \n", split.GetName(), N, p,
+                   j, members.size());
+            fails += 1;
+        }
+    }
+    if (std::count(owner.begin(), owner.end(), ~0ull) != 0)
+    {
+        printf("SPLIT FAIL: %s N: %lu values without partition \n", split.GetName(), N);
+        fails += 1;
+    }
+    return fails;
+}
+
+void test_split_speed(uint64_t N, StrategyType st)
+{
+    // 80/10/10 split: membership queries, the test partition in permutation order and sorted
+    const uint64_t n = N + 1;
+    RandomSplit split(N, {n - 2 * (n / 10), n / 10, n / 10}, st, 1);
+    uint64_t sum = 0;
+    auto t1 = std::chrono::steady_clock::now();
+    for (uint64_t x = 0; x <= N; x++)
+        sum += split.partition(x);
+    auto t2 = std::chrono::steady_clock::now();
+    std::vector<uint64_t> out(split.getSize(2));
+    split.fill(2, 0, out.data(), out.size());
+    auto t3 = std::chrono::steady_clock::now();
+    uint64_t count = 0;
+    for (uint64_t x = split.next_sorted(2, 0); x <= N; x = split.next_sorted(2, x + 1))
+        count++;
+    auto t4 = std::chrono::steady_clock::now();
+    printf("TIME TEST: %s N: %lu ns/partition(): %.1f ns/member: %.1f ns/sorted member: %.1f (%lu)\n", split.GetName(),
+           N, std::chrono::duration<double, std::nano>(t2 - t1).count() / n,
+           std::chrono::duration<double, std::nano>(t3 - t2).count() / out.size(),
+           std::chrono::duration<double, std::nano>(t4 - t3).count() / count, (sum + out[0] + count) & 1);
+}
+
+template <typename T>
+uint64_t test_fill_narrow(uint64_t N, uint64_t K, StrategyType st)
+{
+    // fill() on T words gives the values of it(), also after some values were drawn
+    uint64_t fails = 0;
+    RNG generator(N, K, st, 13);
+    RNG narrow(N, K, st, 13);
+    const uint64_t n = generator.getNumSamples();
+    std::vector<T> out(n);
+    const uint64_t first = std::min(n, (uint64_t)3);
+    for (uint64_t j = 0; j < first; j++)
+        out[j] = (T)narrow.it();
+    narrow.fill(out.data() + first, n - first);
+    for (uint64_t j = 0; j < n; j++)
+    {
+        if ((uint64_t)out[j] != generator.it())
+        {
+            printf("FILL %lu-BIT FAIL: %s N: %lu K: %lu at %lu \n", 8 * sizeof(T), generator.GetName(), N, K, j);
+            fails += 1;
+            break;
+        }
+    }
+    return fails;
+}
+
+template <typename T>
+void test_fill_narrow_speed(uint64_t N, StrategyType st)
+{
+    // Full pass of [0,N] in 64-bit and in T words
+    const uint64_t n = N + 1;
+    std::vector<uint64_t> wide(n);
+    std::vector<T> narrow(n);
+    double best_wide = 1e30, best_narrow = 1e30;
+    for (int r = 0; r < 3; r++)
+    {
+        RNG g1(N, N, st, r), g2(N, N, st, r);
+        auto t1 = std::chrono::steady_clock::now();
+        g1.fill(wide.data(), n);
+        auto t2 = std::chrono::steady_clock::now();
+        g2.fill(narrow.data(), n);
+        auto t3 = std::chrono::steady_clock::now();
+        best_wide = std::min(best_wide, std::chrono::duration<double, std::nano>(t2 - t1).count() / n);
+        best_narrow = std::min(best_narrow, std::chrono::duration<double, std::nano>(t3 - t2).count() / n);
+    }
+    bool same = std::equal(wide.begin(), wide.end(), narrow.begin(), [](uint64_t a, T b) { return a == (uint64_t)b; });
+    printf("TIME TEST: Fill %s N: %lu 64-bit: %.2f ns/value %lu KB, %lu-bit: %.2f ns/value %lu KB%s\n",
+           RNG(N, N, st, 0).GetName(), N, best_wide, n * 8 / 1024, 8 * sizeof(T), best_narrow, n * sizeof(T) / 1024,
+           same ? "" : " FAIL: different values");
+}
+
+double pearson(const std::vector<double> &a, const std::vector<double> &b)
+{
+    double ma = std::accumulate(a.begin(), a.end(), 0.) / a.size();
+    double mb = std::accumulate(b.begin(), b.end(), 0.) / b.size();
+    double cov = 0, va = 0, vb = 0;
+    for (size_t i = 0; i < a.size(); i++)
+    {
+        cov += (a[i] - ma) * (b[i] - mb);
+        va += (a[i] - ma) * (a[i] - ma);
+        vb += (b[i] - mb) * (b[i] - mb);
+    }
+    return cov / std::sqrt(va * vb);
+}
+
+uint64_t test_family_correlation(uint64_t N, uint64_t streams, uint64_t M, StrategyType st)
+{
+    // Pearson correlation between the first M values of consecutive stream ids, the most likely to be
+    // related, at lag 0 and lag 1. Independent streams give |r| of the order of 1/sqrt(M).
+    uint64_t fails = 0;
+    PermutationFamily family(N, st, 13);
+    std::vector<std::vector<double>> series(streams, std::vector<double>(M + 1));
+    for (uint64_t t = 0; t < streams; t++)
+    {
+        uint64_t counter = 0;
+        for (uint64_t j = 0; j <= M; j++)
+            series[t][j] = (double)family.it(t, counter) / (double)N;
+    }
+
+    double max_r = 0;
+    for (uint64_t t = 0; t + 1 < streams; t++)
+    {
+        std::vector<double> a(series[t].begin(), series[t].begin() + M);
+        std::vector<double> b(series[t + 1].begin(), series[t + 1].begin() + M);
+        std::vector<double> b_lag(series[t + 1].begin() + 1, series[t + 1].end());
+        max_r = std::max(max_r, std::fabs(pearson(a, b)));
+        max_r = std::max(max_r, std::fabs(pearson(a, b_lag)));
+    }
+
+    double limit = 5. / std::sqrt((double)M);
+    if (max_r > limit)
+    {
+        printf("FAMILY CORRELATION FAIL: %s N: %lu max|r|: %.4f > %.4f \n", family.GetName(), N, max_r, limit);
+        fails += 1;
+    }
+    printf("%s N=%lu streams=%lu max|r|=%.4f bytes: %lu + 8 per stream (RNG objects: %lu per stream)\n",
+           family.GetName(), N, streams, max_r, sizeof(PermutationFamily) + sizeof(Super_rng),
+           sizeof(RNG) + sizeof(Super_rng));
+    return fails;
+}
+
+template <typename G, typename W>
+uint64_t test_exact_no_repeat(W N, W K, uint64_t passes)
+{
+    // K+1 unique values in [0,N], then full passes over the whole domain for small N
+    uint64_t fails = 0;
+    G generator(N, K, 5);
+    std::set<W> unique_numbers;
+    for (W j = 0; j <= K; j++)
+    {
+        W v = generator.it();
+        if (v > N || !unique_numbers.insert(v).second)
+        {
+            printf("EXACT REPET. FAIL: %s N: %s K: %s \n", generator.GetName(), str128(N).c_str(), str128(K).c_str());
+            return fails + 1;
+        }
+    }
+    for (uint64_t pass = 0; pass < passes; pass++)
+    {
+        generator.reset(N, N, pass);
+        unique_numbers.clear();
+        for (W j = 0; j <= N; j++)
+            unique_numbers.insert(generator.it());
+        if ((W)unique_numbers.size() != N + 1 || *unique_numbers.rbegin() != N)
+        {
+            printf("EXACT PASS FAIL: %s N: %s pass %lu \n", generator.GetName(), str128(N).c_str(), pass);
+            fails += 1;
+        }
+    }
+    return fails;
+}
+
+template <typename G>
+uint64_t test_exact_uniform()
+{
+    // The 20 ordered pairs of [0,4] as the first two values, 1000 times each on average
+    uint64_t fails = 0;
+    uint64_t counts[25] = {0};
+    for (uint64_t seed = 0; seed < 20000; seed++)
+    {
+        G generator(4, 1, seed);
+        uint64_t a = generator.it();
+        counts[5 * a + generator.it()]++;
+    }
+    for (uint64_t a = 0; a < 5; a++)
+        for (uint64_t b = 0; b < 5; b++)
+            if ((a == b) != (counts[5 * a + b] == 0) || (a != b && (counts[5 * a + b] < 850 || counts[5 * a + b] > 1150)))
+            {
+                G generator(4, 1, 0);
+                printf("EXACT UNIFORM FAIL: %s pair (%lu,%lu) drawn %lu times \n", generator.GetName(), a, b,
+                       counts[5 * a + b]);
+                return fails + 1;
+            }
+    return fails;
+}
+
+uint64_t test_auto_choice(uint64_t N, uint64_t K, uint64_t quality, uint64_t budget, const char *expected)
+{
+    // Backend chosen with the default cost model, then the values of RNG(AUTO) are those of the backend
+    uint64_t fails = 0;
+    RNG generator(N, K, AUTO, 3, quality, budget);
+    if (std::string(generator.GetName()) != std::string("Auto(") + expected + ")")
+    {
+        printf("AUTO CHOICE FAIL: N: %lu K: %lu quality: %lu budget: %lu %s instead of Auto(%s) \n", N, K, quality,
+               budget, generator.GetName(), expected);
+        fails += 1;
+    }
+    std::set<uint64_t> unique_numbers;
+    for (uint64_t j = 0; j <= std::min(K, (uint64_t)100000); j++)
+    {
+        uint64_t v = generator.it();
+        if (v > N || !unique_numbers.insert(v).second)
+        {
+            printf("AUTO REPET. FAIL: %s N: %lu K: %lu \n", generator.GetName(), N, K);
+            return fails + 1;
+        }
+    }
+    return fails;
+}
+
+uint64_t test_id_server(uint64_t N, uint64_t clients, uint32_t lease, StrategyType st)
+{
+    // Concurrent clients until the sequence is exhausted: each value once, the series of RNG(N, N, st, seed).
+    // Then a restart from the checkpoint continues the series of a second sequence, a third drawn.
+    uint64_t fails = 0;
+    const std::string path = "/tmp/rngwr_test_" + std::to_string(getpid());
+    unlink((path + ".ckpt").c_str());
+    std::vector<std::vector<uint64_t>> received(clients);
+    {
+        IdServer server(path + ".sock", path + ".ckpt", N, N, st, 3);
+        std::thread serving(&IdServer::run, &server);
+        std::vector<std::thread> threads;
+        for (uint64_t c = 0; c < clients; c++)
+            threads.emplace_back([&, c]()
+                                 {
+                                     IdClient client(path + ".sock", lease);
+                                     uint64_t id;
+                                     while (client.next(id))
+                                         received[c].push_back(id); });
+        for (auto &t : threads)
+            t.join();
+        server.stop();
+        serving.join();
+    }
+    std::vector<uint64_t> all;
+    for (auto &r : received)
+        all.insert(all.end(), r.begin(), r.end());
+    std::sort(all.begin(), all.end());
+    if (all.size() != N + 1 || std::adjacent_find(all.begin(), all.end()) != all.end() || all.back() != N)
+    {
+        printf("ID SERVER FAIL: N: %lu clients: %lu %lu values instead of %lu, or repeated \n", N, clients, all.size(),
+               N + 1);
+        fails += 1;
+    }
+
+    // Restart: the second server gives the values after the ones of the first
+    unlink((path + ".ckpt").c_str());
+    RNG series(N, N, st, 5);
+    for (uint64_t run = 0; run < 2; run++)
+    {
+        IdServer server(path + ".sock", path + ".ckpt", N, N, st, 5);
+        std::thread serving(&IdServer::run, &server);
+        IdClient client(path + ".sock", lease);
+        for (uint64_t j = 0; j < (N + 1) / 3; j++)
+        {
+            uint64_t id;
+            if (!client.next(id) || id != series.it())
+            {
+                printf("ID SERVER RESTART FAIL: N: %lu run %lu value %lu \n", N, run, j);
+                fails += 1;
+                break;
+            }
+        }
+        // The rest of the lease of the client is lost
+        for (uint64_t j = (N + 1) / 3; j % lease != 0; j++)
+            series.it();
+        server.stop();
+        serving.join();
+    }
+    {
+        IdServer other(path + ".sock", path + ".ckpt", N + 1, N + 1, st, 5);
+        if (other.ok())
+        {
+            printf("ID SERVER FAIL: the checkpoint of another sequence is used \n");
+            fails += 1;
+        }
+    }
+    unlink((path + ".ckpt").c_str());
+    return fails;
+}
+
+uint64_t test_id_server_restart(uint64_t issued, StrategyType st)
+{
+    // With K << N each value draws from the Mersenne Twister. The checkpoint holds its state, thus the restart
+    // after many values takes the same time as after a few, and the series continues.
+    uint64_t fails = 0;
+    const uint64_t N = 0xFFFFFFFFFFFFFFFFull, K = 1ull << 40;
+    const std::string path = "/tmp/rngwr_test_" + std::to_string(getpid());
+    unlink((path + ".ckpt").c_str());
+    std::vector<uint64_t> values(ID_MAX_LEASE);
+    {
+        IdServer server(path + ".sock", path + ".ckpt", N, K, st, 5);
+        std::thread serving(&IdServer::run, &server);
+        IdClient client(path + ".sock");
+        for (uint64_t done = 0; done < issued;)
+            done += client.lease(values.data(), (uint32_t)std::min((uint64_t)ID_MAX_LEASE, issued - done));
+        server.stop();
+        serving.join();
+    }
+
+    RNG series(N, K, st, 5);
+    for (uint64_t done = 0; done < issued; done += values.size())
+        series.fill(values.data(), std::min((uint64_t)values.size(), issued - done));
+
+    auto t1 = std::chrono::steady_clock::now();
+    IdServer server(path + ".sock", path + ".ckpt", N, K, st, 5);
+    auto t2 = std::chrono::steady_clock::now();
+    double us = std::chrono::duration<double, std::micro>(t2 - t1).count();
+    std::thread serving(&IdServer::run, &server);
+    {
+        IdClient client(path + ".sock");
+        std::vector<uint64_t> continued(1000), expected(1000);
+        series.fill(expected.data(), expected.size());
+        if (!server.ok() || server.getIssued() != issued ||
+            client.lease(continued.data(), continued.size()) != continued.size() || continued != expected || us > 5000)
+        {
+            printf("ID SERVER RESTART FAIL: %lu values issued, restart(us): %.1f \n", issued, us);
+            fails += 1;
+        }
+    }
+    server.stop();
+    serving.join();
+    printf("TIME TEST: IdServer restart after %lu values T(us): %.1f\n", issued, us);
+    unlink((path + ".ckpt").c_str());
+    return fails;
+}
+
+uint64_t test_shared_rng(uint64_t N, uint64_t K, uint64_t processes, uint64_t batch, StrategyType st)
+{
+    // Forked processes draw from one segment until it is exhausted, the first one dies in the middle of its
+    // first claim. The others draw each value once, among the K+1 first values of Super_rng(N, N, level, seed, true).
+    uint64_t fails = 0;
+    const std::string name = "/rngwr_test_" + std::to_string(getpid());
+    SharedRNG::remove(name);
+    SharedRNG creator(name, N, K, st, 9, batch);
+
+    size_t bytes = (K + 2) * sizeof(uint64_t);
+    void *shared = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    std::atomic<uint64_t> *received = new (shared) std::atomic<uint64_t>(0);
+    uint64_t *values = (uint64_t *)shared + 1;
+    std::vector<pid_t> pids;
+    for (uint64_t p = 0; p < processes; p++)
+    {
+        fflush(stdout);
+        pid_t pid = fork();
+        if (pid == 0)
+        {
+            SharedRNG rng(name, batch);
+            uint64_t v;
+            for (uint64_t drawn = 0; rng.ok() && rng.next(v); drawn++)
+            {
+                if (p == 0 && drawn == batch / 2)
+                    _exit(0);
+                values[received->fetch_add(1)] = v;
+            }
+            _exit(rng.ok() ? 0 : 1);
+        }
+        pids.push_back(pid);
+    }
+    for (pid_t pid : pids)
+    {
+        int status;
+        if (waitpid(pid, &status, 0) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        {
+            printf("SHARED RNG FAIL: a process could not attach \n");
+            fails += 1;
+        }
+    }
+
+    Super_rng series(N, N, SuperLevel(st), 9, true);
+    std::vector<uint64_t> expected(K + 1);
+    for (auto &e : expected)
+        e = series.it();
+    std::sort(expected.begin(), expected.end());
+    uint64_t n = received->load();
+    std::sort(values, values + n);
+    bool unknown = false;
+    for (uint64_t j = 0; j < n; j++)
+        unknown |= !std::binary_search(expected.begin(), expected.end(), values[j]);
+    if (unknown || std::adjacent_find(values, values + n) != values + n || n > K + 1 || n + batch < K + 1 ||
+        creator.getClaimed() != K + 1)
+    {
+        printf("SHARED RNG FAIL: N: %lu K: %lu processes: %lu %lu values of %lu claimed, repeated or unknown \n", N, K,
+               processes, n, creator.getClaimed());
+        fails += 1;
+    }
+    munmap(shared, bytes);
+
+    SharedRNG other(name, N, K, st, 10);
+    if (other.ok())
+    {
+        printf("SHARED RNG FAIL: the segment of another sequence is used \n");
+        fails += 1;
+    }
+    SharedRNG::remove(name);
+    return fails;
+}
+
+template <uint64_t N, uint64_t Level, typename T>
+uint64_t test_constexpr_permutation(const std::array<T, N + 1> &table, uint64_t seed)
+{
+    // The table built by the compiler is the series of the runtime generator
+    RNG rng(N, N, (StrategyType)(SUPER0 + Level), seed);
+    for (uint64_t j = 0; j <= N; j++)
+    {
+        uint64_t expected = rng.it();
+        if (table[j] != expected)
+        {
+            printf("CONSTEXPR FAIL: N: %lu level: %lu value %lu: %lu instead of %lu \n", N, Level, j, (uint64_t)table[j],
+                   expected);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+uint64_t test_stratified(uint64_t N, const std::vector<uint64_t> &sizes, const std::vector<uint64_t> &quotas)
+{
+    // The interleaved sample holds the quota first members of each stratum, without repeat
+    uint64_t fails = 0;
+    StratifiedSampler sampler(N, sizes, quotas, 21);
+    const uint64_t S = sampler.getNumStrata();
+    std::vector<uint64_t> out(sampler.getNumSamples() + 1);
+    uint64_t n = sampler.fill(out.data(), out.size());
+    std::vector<std::vector<uint64_t>> drawn(S);
+    bool misplaced = false;
+    for (uint64_t j = 0; j < n; j++)
+    {
+        uint64_t s = sampler.stratum(out[j]);
+        misplaced |= out[j] > N || out[j] < sampler.getStart(s) || out[j] - sampler.getStart(s) >= sampler.getSize(s);
+        drawn[s].push_back(out[j]);
+    }
+    bool members = true;
+    for (uint64_t s = 0; s < S; s++)
+    {
+        std::vector<uint64_t> expected(sampler.getQuota(s));
+        sampler.fill(s, 0, expected.data(), expected.size());
+        std::sort(expected.begin(), expected.end());
+        std::sort(drawn[s].begin(), drawn[s].end());
+        members &= drawn[s] == expected && std::adjacent_find(expected.begin(), expected.end()) == expected.end();
+    }
+    if (n != sampler.getNumSamples() || misplaced || !members || sampler.getRemaining() != 0)
+    {
+        printf("STRATIFIED FAIL: N: %lu strata: %lu %lu values instead of %lu, repeated or misplaced \n", N, S, n,
+               sampler.getNumSamples());
+        fails += 1;
+    }
+
+    // next() and at() give the values of fill(), rewind() restarts them
+    sampler.rewind();
+    uint64_t v;
+    for (uint64_t j = 0; j < n; j += 1 + j / 2)
+    {
+        if (!sampler.next(v) || v != out[j] || sampler.at(j) != out[j])
+        {
+            printf("STRATIFIED NEXT FAIL: N: %lu strata: %lu value %lu \n", N, S, j);
+            fails += 1;
+            break;
+        }
+        for (uint64_t k = j + 1; k < j + 1 + j / 2 && k < n; k++)
+            sampler.next(v);
+    }
+    return fails;
+}
+
+uint64_t test_stratified_uniform(uint64_t seeds)
+{
+    // Strata of 10 values with quotas of 3: each value is drawn by 30% of the seeds. The interleaving of
+    // two equal quotas gives half of the first 1000 values to each stratum.
+    uint64_t fails = 0;
+    std::vector<uint64_t> hits(30, 0);
+    for (uint64_t seed = 0; seed < seeds; seed++)
+    {
+        StratifiedSampler sampler(29, {10, 10, 10}, {3, 3, 3}, seed);
+        uint64_t v;
+        while (sampler.next(v))
+            hits[v]++;
+    }
+    const double sigma = std::sqrt(seeds * 0.3 * 0.7);
+    for (uint64_t x = 0; x < 30; x++)
+    {
+        if (std::fabs(hits[x] - 0.3 * seeds) > 5 * sigma)
+        {
+            printf("STRATIFIED UNIFORM FAIL: value %lu drawn %lu times instead of %.0f \n", x, hits[x], 0.3 * seeds);
+            fails += 1;
+        }
+    }
+    StratifiedSampler halves(1999999, {1000000, 1000000}, {1000, 1000}, 5);
+    uint64_t first = 0, v;
+    for (uint64_t j = 0; j < 1000 && halves.next(v); j++)
+        first += v < 1000000;
+    if (first < 450 || first > 550)
+    {
+        printf("STRATIFIED INTERLEAVE FAIL: %lu of the first 1000 values in the first stratum \n", first);
+        fails += 1;
+    }
+    return fails;
+}
+
+void test_stratified_speed(uint64_t strata, uint64_t quota)
+{
+    // Strata of 1 to 100 quotas, against one RNG per stratum and against rejection from one RNG of [0,N]
+    std::mt19937_64 engine(3);
+    std::vector<uint64_t> sizes(strata), quotas(strata, quota), starts(strata);
+    uint64_t N = 0;
+    for (uint64_t s = 0; s < strata; s++)
+    {
+        sizes[s] = quota * (1 + engine() % 100);
+        starts[s] = N;
+        N += sizes[s];
+    }
+    N -= 1;
+    const uint64_t n = strata * quota;
+    std::vector<uint64_t> out(n);
+    uint64_t sum = 0;
+
+    auto t1 = std::chrono::steady_clock::now();
+    StratifiedSampler sampler(N, sizes, quotas, 1);
+    sampler.fill(out.data(), n);
+    sum += out[n - 1];
+    auto t2 = std::chrono::steady_clock::now();
+    for (uint64_t s = 0; s < strata; s++)
+        sampler.fill(s, 0, out.data() + s * quota, quota);
+    sum += out[n - 1];
+    auto t3 = std::chrono::steady_clock::now();
+    for (uint64_t s = 0; s < strata; s++)
+    {
+        RNG rng(sizes[s] - 1, quota - 1, SUPER5, s);
+        rng.fill(out.data() + s * quota, quota);
+        for (uint64_t j = 0; j < quota; j++)
+            out[s * quota + j] += starts[s];
+    }
+    sum += out[n - 1];
+    auto t4 = std::chrono::steady_clock::now();
+    RNG all(N, N, SUPER5, 1);
+    std::vector<uint64_t> taken(strata, 0);
+    uint64_t drawn = 0, left = n;
+    while (left > 0)
+    {
+        uint64_t x = all.it();
+        uint64_t s = std::upper_bound(starts.begin(), starts.end(), x) - starts.begin() - 1;
+        drawn++;
+        if (taken[s] < quota)
+        {
+            out[n - left] = x;
+            taken[s]++;
+            left--;
+        }
+    }
+    sum += out[n - 1];
+    auto t5 = std::chrono::steady_clock::now();
+    auto ns = [&](std::chrono::steady_clock::time_point a, std::chrono::steady_clock::time_point b)
+    { return std::chrono::duration<double, std::nano>(b - a).count() / n; };
+    printf("TIME TEST: %s strata: %lu quota: %lu N: %lu ns/value interleaved: %.1f per stratum: %.1f "
+           "RNG per stratum: %.1f rejection: %.1f (%lu draws) (%lu)\n",
+           sampler.GetName(), strata, quota, N, ns(t1, t2), ns(t2, t3), ns(t3, t4), ns(t4, t5), drawn, sum & 1);
+}
+
+uint64_t test_pvalues()
+{
+    // Tabulated quantiles, and the far tail where 1 - CDF would round to 0
+    uint64_t fails = 0;
+    const double quantiles[][3] = {{3.841458821, 1, 0.05}, {18.30703805, 10, 0.05}, {124.3421134, 100, 0.05},
+                                   {1118.948045, 1000, 0.005}};
+    for (auto &q : quantiles)
+    {
+        if (std::fabs(chi2_pvalue(q[0], q[1]) - q[2]) > 1e-6)
+        {
+            printf("PVALUE FAIL: chi2 %f dof %.0f p %g instead of %g \n", q[0], q[1], chi2_pvalue(q[0], q[1]), q[2]);
+            fails += 1;
+        }
+    }
+    double tail = chi2_pvalue(1000, 10);
+    if (!(tail > 1e-210 && tail < 1e-206) || std::fabs(normal_pvalue(-1.959963985) - 0.05) > 1e-6)
+    {
+        printf("PVALUE FAIL: tail %g \n", tail);
+        fails += 1;
+    }
+    return fails;
+}
+
+struct Mt64Source
+{
+    std::mt19937_64 engine{7};
+    void fill(uint64_t *out, uint64_t n)
+    {
+        for (uint64_t j = 0; j < n; j++)
+            out[j] = engine();
+    }
+};
+
+struct WeylSource
+{
+    uint64_t x = 0;
+    void fill(uint64_t *out, uint64_t n)
+    {
+        for (uint64_t j = 0; j < n; j++)
+            out[j] = (x += 0x9E3779B97F4A7C15ull);
+    }
+};
+
+uint64_t test_battery_reference()
+{
+    // std::mt19937_64 passes every test, a Weyl sequence fails all but the bits
+    uint64_t fails = 0;
+    Mt64Source mt;
+    WeylSource weyl;
+    std::vector<BatteryResult> good = RunBattery(mt, 0xFFFFFFFFFFFFFFFFull, 1 << 20);
+    std::vector<BatteryResult> bad = RunBattery(weyl, 0xFFFFFFFFFFFFFFFFull, 1 << 20);
+    for (size_t t = 0; t < good.size(); t++)
+    {
+        if (!(good[t].pvalue > 1e-4) || (good[t].name != "bits" && !(bad[t].pvalue < 1e-6)))
+        {
+            printf("BATTERY FAIL: %s p: %g (mt19937_64) %g (Weyl) \n", good[t].name.c_str(), good[t].pvalue,
+                   bad[t].pvalue);
+            fails += 1;
+        }
+    }
+    // Small domains: exact expectations
+    for (uint64_t N : {1ull, 5ull, 1000ull})
+    {
+        std::mt19937_64 engine(N);
+        TestBattery battery(N);
+        std::vector<uint64_t> chunk(1000);
+        for (uint64_t r = 0; r < 1000; r++)
+        {
+            for (auto &v : chunk)
+                v = engine() % (N + 1);
+            battery.push(chunk.data(), chunk.size());
+        }
+        for (const BatteryResult &result : battery.results())
+        {
+            if (result.pvalue < 1e-4)
+            {
+                printf("BATTERY FAIL: %s N: %lu p: %g (mt19937_64) \n", result.name.c_str(), N, result.pvalue);
+                fails += 1;
+            }
+        }
+    }
+    return fails;
+}
+
+void test_battery(uint64_t N, uint64_t K, StrategyType st)
+{
+    RNG generator(N, K, st, 1);
+    std::vector<BatteryResult> results = RunBattery(generator, N, K + 1);
+    printf("%s K=%lu N=%lu", generator.GetName(), K, N);
+    for (const BatteryResult &r : results)
+        printf(" %s=%.3g", r.name.c_str(), r.pvalue);
+    printf("\n");
+}
+
+void test_battery_speed(uint64_t n)
+{
+    std::vector<uint64_t> values(n);
+    RNG(0xFFFFFFFFFFFFFFFFull, n, SUPER5, 1).fill(values.data(), n);
+    TestBattery battery(0xFFFFFFFFFFFFFFFFull);
+    auto t1 = std::chrono::steady_clock::now();
+    for (uint64_t j = 0; j < n; j += 4096)
+        battery.push(values.data() + j, std::min((uint64_t)4096, n - j));
+    auto t2 = std::chrono::steady_clock::now();
+    printf("TIME TEST: battery values: %lu ns/value: %.1f (%lu)\n", n,
+           std::chrono::duration<double, std::nano>(t2 - t1).count() / n, battery.results().size());
+}
+
+void SHORT_UNIT_TEST(std::vector<StrategyType> &strategies)
+{
+    uint64_t runs = 3;
+    for (const StrategyType &strat : strategies)
+    {
+        test_no_repeat(0, 0, runs, strat);
+        test_no_repeat(1, 1, runs, strat);
+        test_no_repeat(1, 0, runs, strat);
+        test_no_repeat(3, 3, runs, strat);
+        test_no_repeat(4, 4, runs, strat);
+        test_no_repeat(5, 4, runs, strat);
+
+        test_no_repeat(10, 2, runs * 5, strat);
+        test_no_repeat(100, 10, runs * 10, strat);
+        test_no_repeat(100, 50, runs * 2, strat);
+        test_no_repeat(100, 100, runs, strat);
+
+        test_no_repeat(127, 127, runs, strat);
+        test_no_repeat(128, 128, runs, strat);
+        test_no_repeat(255, 255, runs, strat);
+        test_no_repeat(256, 256, runs, strat);
+    }
+
+    for (const StrategyType &strat : strategies)
+    {
+
+        test_N_K_API(0, 0, runs, strat);
+        test_N_K_API(1, 1, runs, strat);
+        test_N_K_API(3, 3, runs, strat);
+        test_N_K_API(5, 4, runs, strat);
+
+        test_N_K_API(10, 2, runs * 5, strat);
+        test_N_K_API(100, 10, runs * 10, strat);
+        test_N_K_API(100, 50, runs, strat);
+        test_N_K_API(100, 100, runs, strat);
+
+        test_N_K_API(127, 127, runs, strat);
+        test_N_K_API(128, 128, runs, strat);
+        test_N_K_API(255, 255, runs, strat);
+        test_N_K_API(256, 256, runs, strat);
+        for (uint64_t seed = 0; seed < 4; seed++)
+        {
+            test_past_the_end(100, 100, seed, strat);
+            test_past_the_end(1000, 500, seed, strat);
+            test_past_the_end(65535, 65535, seed, strat);
+        }
+    }
+    test_baseline_series();
+    for (uint64_t level = 0; level <= 5; level++)
+        for (uint64_t seed = 0; seed < 4; seed++)
+            for (uint64_t N : {1ull, 100ull, 65535ull, (1ull << 40) + 3, 0xFFFFFFFFFFFFFFFFull})
+                test_walk_past_the_end(N, level, seed);
+
+    for (const StrategyType &strat : strategies)
+    {
+        test_reseed(0, 0, runs, strat);
+        test_reseed(100, 10, runs, strat);
+        test_reseed(1000, 1000, runs, strat);
+        test_reseed(0xFFFFFFFFFFFFFFFFull, 1000, runs, strat);
+    }
+
+    std::vector<rngwr_strategy> c_strategies = {RNGWR_SUPER1, RNGWR_SUPER2, RNGWR_SUPER3, RNGWR_SUPER4, RNGWR_SUPER5};
+    std::vector<StrategyType> cpp_strategies = {SUPER1, SUPER2, SUPER3, SUPER4, SUPER5};
+    for (size_t s = 0; s < c_strategies.size(); s++)
+    {
+        test_capi(100, 10, c_strategies[s], cpp_strategies[s]);
+        test_capi(1000, 1000, c_strategies[s], cpp_strategies[s]);
+        test_capi(0xFFFFFFFFFFFFFFFFull, 1000, c_strategies[s], cpp_strategies[s]);
+    }
+    test_capi_restore(1 << 24, RNGWR_SUPER5);
+
+    for (const StrategyType &strat : strategies)
+    {
+        test_prefetch(100, 100, 2, 0, strat);
+        test_prefetch(1000, 1000, 16, 4, strat);
+        test_prefetch(0xFFFFFFFFFFFFFFFFull, 10000, 4096, 1024, strat);
+        test_prefetch(100, 9, 64, 16, strat);
+    }
+
+    for (const StrategyType &strat : strategies)
+    {
+        test_family_no_repeat(0, 3, strat);
+        test_family_no_repeat(5, 10, strat);
+        test_family_no_repeat(100, 10, strat);
+        test_family_no_repeat(1000, 10, strat);
+        test_family_no_repeat(65535, 3, strat);
+    }
+
+    std::vector<StrategyType> sorted_strategies = {SORTED};
+    for (const StrategyType &strat : sorted_strategies)
+    {
+        test_no_repeat(0, 0, runs, strat);
+        test_no_repeat(1, 0, runs, strat);
+        test_no_repeat(5, 4, runs, strat);
+        test_no_repeat(100, 10, runs * 10, strat);
+        test_no_repeat(256, 256, runs, strat);
+        test_N_K_API(0, 0, runs, strat);
+        test_N_K_API(5, 4, runs, strat);
+        test_N_K_API(100, 50, runs, strat);
+        test_N_K_API(256, 256, runs, strat);
+    }
+    test_sorted(0, 0, runs);
+    test_sorted(10, 2, runs * 5);
+    test_sorted(100, 10, runs * 10);
+    test_sorted(100, 99, runs);
+    test_sorted(1000, 1000, runs);
+    test_sorted(0xFFFFFFFFFFFFFFFFull, 1000, runs);
+
+    test_grid_no_repeat({}, 0, runs);
+    test_grid_no_repeat({1, 1}, 0, runs);
+    test_grid_no_repeat({7}, 6, runs);
+    test_grid_no_repeat({1, 1000, 1}, 999, runs);
+    test_grid_no_repeat({2, 3}, 5, runs);
+    test_grid_no_repeat({10, 30, 7}, 2099, runs);
+    test_grid_no_repeat({100000, 30000, 7}, 10000, runs);
+    test_grid_no_repeat({0xFFFFFFFFFFFFFFFFull}, 1000, runs);
+    test_grid_no_repeat({0xFFFFFFFFFFFFFFFFull, 0xFFFFFFFFFFFFFFFFull}, 1000, runs);
+
+    for (const StrategyType &strat : strategies)
+    {
+        test_apply_permutation<uint64_t>(0, 0, 1, strat);
+        test_apply_permutation<uint64_t>(100, 10, 1, strat);
+        test_apply_permutation<uint64_t>(1000, 1000, 2, strat);
+        test_apply_permutation<Record24>(1000, 1000, 1, strat);
+    }
+    test_apply_permutation<uint64_t>(1000000, 1000000, 1, SUPER5); // Partitioned path
+    test_apply_permutation<uint64_t>(1000000, 100000, 3, SUPER5);
+    test_apply_permutation<Record24>(300000, 300000, 2, SUPER1);
+
+    for (const StrategyType &strat : strategies)
+    {
+        test_locality(0, 0, 1, 1, strat);
+        test_locality(100, 100, 7, 3, strat);
+        test_locality(1000, 1000, 64, 1, strat);
+        test_locality(1000, 500, 64, 4, strat);
+        test_locality(4095, 4095, 512, 16, strat);
+        test_locality(100000, 100000, 4096, 8, strat);
+        test_locality(1000, 1000, 5000, 2, strat);
+    }
+
+    for (const StrategyType &strat : strategies)
+    {
+        test_growing(0, {1, 1, 1, 1, 0, 5}, strat);
+        test_growing(999, {500, 1000, 300, 1, 0, 4000, 10000, 17}, strat);
+        test_growing(63, {64, 1, 1, 64, 10, 100, 0, 1000, 2000, 1}, strat);
+        test_growing_uniform(strat);
+    }
+
+    for (const StrategyType &strat : strategies)
+    {
+        for (uint64_t N : {1ull, 2ull, 10ull, 1000ull, 123456789ull, 0xFFFFFFFFFFFFFFFFull})
+            test_unpermute<uint64_t>(N, strat);
+        test_unpermute<uint128_t>((uint128_t)1 << 100, strat);
+        test_unpermute<uint128_t>(~(uint128_t)0, strat);
+        for (uint64_t N : {3ull, 100ull, 4095ull, 65535ull, 200000ull, 123456789ull, 0xFFFFFFFFull})
+            test_round_table(N, strat);
+
+        test_split(0, {1}, strat);
+        test_split(9, {8, 1, 1}, strat);
+        test_split(1000, {801, 0, 100, 100}, strat);
+        test_split(100000, {80000, 10000, 10001}, strat);
+    }
+
+    for (const StrategyType &strat : strategies)
+    {
+        for (uint64_t N : {0ull, 1ull, 30ull, 1000ull, 65535ull})
+        {
+            test_fill_narrow<uint16_t>(N, N, strat);
+            test_fill_narrow<uint32_t>(N, N, strat);
+        }
+        test_fill_narrow<uint16_t>(65535, 100, strat); // Without cycle walking
+        test_fill_narrow<uint32_t>(65536, 65536, strat);
+        test_fill_narrow<uint32_t>(1000000, 1000000, strat);
+        test_fill_narrow<uint32_t>(0xFFFFFFFFull, 100000, strat);
+    }
+
+    for (StrategyType strat : {SUPER1, SUPER5})
+    {
+        test_batch_no_repeat(0, 0, 3, strat);
+        test_batch_no_repeat(5, 4, 9, strat);
+        test_batch_no_repeat(100, 10, 17, strat);
+        test_batch_no_repeat(1000, 1000, 20, strat);
+        test_batch_no_repeat(0xFFFFFFFFFFFFFFFFull, 1000, 20, strat);
+    }
+
+    for (uint64_t N : {0ull, 1ull, 4ull, 1000ull})
+    {
+        test_exact_no_repeat<Table_rng>(N, N / 2, 3);
+        test_exact_no_repeat<Sparse_rng>(N, N / 2, 3);
+    }
+    test_exact_no_repeat<Table_rng>(1000000ull, 999999ull, 1);
+    test_exact_no_repeat<Sparse_rng>(0xFFFFFFFFFFFFFFFFull, 100000ull, 0);
+    test_exact_no_repeat<Sparse_rng_t<uint128_t>>(~(uint128_t)0, (uint128_t)10000, 0);
+    test_exact_no_repeat<Table_rng_t<uint128_t>>((uint128_t)1000, (uint128_t)1000, 1);
+    test_exact_uniform<Table_rng>();
+    test_exact_uniform<Sparse_rng>();
+
+    test_auto_choice(999, 999, 5, 64ull << 20, "Table");
+    test_auto_choice(999, 999, 4, 64ull << 20, "Super5");
+    test_auto_choice((1 << 20) - 1, (1 << 20) - 1, 5, 64ull << 20, "Table");
+    test_auto_choice(0xFFFFFFFFFFFFFFFFull, 999, 5, 64ull << 20, "Sparse");
+    test_auto_choice((1ull << 30) - 1, (1ull << 30) - 1, 4, 64ull << 20, "Super5");
+    test_auto_choice(0xFFFFFFFFFFFFFFFFull, 100000, 0, 64ull << 20, "Super0");
+    test_auto_choice(1000000, 1000000, 5, 1 << 20, "Super5"); // Over the budget: ERROR and SUPER5
+    test_no_repeat(1000, 1000, 3, AUTO);
+    test_no_repeat(0xFFFFFFFFFFFFFFFFull, 10000, 3, AUTO);
+
+    test_id_server(99999, 8, 1000, SUPER5);
+    test_id_server(9999, 3, 7, SUPER2);
+    test_id_server_restart(1 << 24, SUPER5);
+
+    test_shared_rng(99999, 99999, 8, 1000, SUPER5);
+    test_shared_rng(0xFFFFFFFFFFFFFFFFull, 99999, 4, 7, SUPER2);
+    test_shared_rng(1000, 500, 3, 1, SUPER4);
+
+    test_pvalues();
+    test_battery_reference();
+
+    static constexpr auto tiny = rngwr_constexpr::make_permutation<0, 1>(3);
+    static constexpr auto small = rngwr_constexpr::make_permutation<2, 5, uint8_t>(3);
+    static constexpr auto plain = rngwr_constexpr::make_permutation<1000, 0, uint16_t>(1);
+    static constexpr auto super1 = rngwr_constexpr::make_permutation<1000, 1, uint16_t>(1);
+    static constexpr auto super2 = rngwr_constexpr::make_permutation<1000, 2, uint16_t>(1);
+    static constexpr auto super3 = rngwr_constexpr::make_permutation<4095, 3, uint16_t>(1);
+    static constexpr auto super4 = rngwr_constexpr::make_permutation<1000, 4, uint16_t>(1);
+    static constexpr auto super5 = rngwr_constexpr::make_permutation<20000, 5, uint32_t>(1);
+    test_constexpr_permutation<0, 1>(tiny, 3);
+    test_constexpr_permutation<2, 5>(small, 3);
+    test_constexpr_permutation<1000, 0>(plain, 1);
+    test_constexpr_permutation<1000, 1>(super1, 1);
+    test_constexpr_permutation<1000, 2>(super2, 1);
+    test_constexpr_permutation<4095, 3>(super3, 1);
+    test_constexpr_permutation<1000, 4>(super4, 1);
+    test_constexpr_permutation<20000, 5>(super5, 1);
+
+    test_stratified(999, {1000}, {1000});
+    test_stratified(99, {10, 0, 1, 89}, {10, 0, 1, 20});
+    test_stratified(1000000, {1, 2, 3, 999995}, {1, 1, 3, 50000});
+    test_stratified(0xFFFFFFFFFFFFFFFEull, {1ull << 63, (1ull << 63) - 1}, {1000, 1000});
+    test_stratified(999, {500, 600}, {600, 10}); // ERROR: the sizes and a quota are cut
+    test_stratified_uniform(10000);
+}
+
+void SAMPLER_UNIT_TEST(std::vector<StrategyType> &strategies)
+{
+    for (const StrategyType &strat : strategies)
+    {
+        test_distributed_sampler(0, 1, 2, strat);
+        test_distributed_sampler(5, 2, 2, strat);
+        test_distributed_sampler(100, 3, 3, strat);
+        test_distributed_sampler(1000, 8, 2, strat);
+        test_distributed_sampler(100000, 4, 2, strat);
+    }
+}
+
+void BIG_UNIT_TEST(std::vector<StrategyType> &strategies)
+{
+    uint64_t runs = 1;
+
+    for (const StrategyType &strat : strategies)
+    {
+        test_no_repeat(100 * 1000000, 1000000, runs, strat);
+        test_no_repeat(0xFFFFFFFFFFFFFFFFull, 100000, runs, strat);
+        test_no_repeat(1000000, 10000, runs, strat);
+        test_no_repeat(1000, 1000, runs, strat);
+    }
+
+    for (const StrategyType &strat : strategies)
+    {
+        test_N_K_API(100 * 1000000, 1000000, runs, strat);
+        test_N_K_API(0xFFFFFFFFFFFFFFFFull, 100000, runs, strat);
+        test_N_K_API(1000000, 10000, runs, strat);
+        test_N_K_API(1000, 1000, runs, strat);
+    }
+
+    test_no_repeat(100 * 1000000, 1000000, runs, SORTED);
+    test_no_repeat(0xFFFFFFFFFFFFFFFFull, 100000, runs, SORTED);
+    test_sorted(100 * 1000000, 1000000, runs);
+    test_sorted(0xFFFFFFFFFFFFFFFFull, 100000, runs);
+}
+
+void WIDE_UNIT_TEST(std::vector<StrategyType> &strategies)
+{
+    uint64_t runs = 3;
+    uint128_t b64 = 0xFFFFFFFFFFFFFFFFull;
+    uint128_t b128 = ~(uint128_t)0;
+
+    for (const StrategyType &strat : strategies)
+    {
+        // Small domains give the same guarantees as the 64-bit words
+        test_no_repeat128(0, 0, runs, strat);
+        test_no_repeat128(5, 4, runs, strat);
+        test_no_repeat128(256, 256, runs, strat);
+
+        // Around the 64-bit boundary and beyond
+        test_no_repeat128(b64, 10000, runs, strat);
+        test_no_repeat128(b64 + 1, 10000, runs, strat);
+        test_no_repeat128((uint128_t)1 << 100, 10000, runs, strat);
+        test_no_repeat128(b128 - 1, 10000, runs, strat);
+        test_no_repeat128(b128, 10000, runs, strat);
+    }
+
+    for (const StrategyType &strat : strategies)
+    {
+        test_operm5_128((uint128_t)1 << 100, 65535, 3, strat);
+        test_operm5_128(b128, 65535, 3, strat);
+        test_uniform128((uint128_t)1 << 100, 65535, 3, strat);
+        test_uniform128(b128, 65535, 3, strat);
+    }
+}
+
+void RANDOM_TEST(std::vector<StrategyType> &strategies)
+{
+    // Test random seed behaviour:
+    // * Fixed random seed -> same series
+    // * Diff random seed -> chance to get different series
+    for (const StrategyType &strat : strategies)
+    {
+        test_random_seed_effect(0xFFFFFFFFFFFFFFFFull, 3, 10, strat);
+    }
+
+    // OPERM5 test for each method, varying N and K
+    uint64_t b8 = 255;
+    uint64_t b16 = 65535;
+    uint64_t b32 = 4294967295;
+    uint64_t b64 = 0xFFFFFFFFFFFFFFFFull;
+    uint64_t runs = 10;
+
+    for (const StrategyType &strat : strategies)
+    {
+        test_operm5(b8, b8, runs, strat);
+
+        test_operm5(b16, b8, runs, strat);
+        test_operm5(b16, b16, runs, strat);
+
+        test_operm5(100 * 1000000, 1000000, 1, strat);
+
+        test_operm5(b32, b8, runs, strat);
+        test_operm5(b32, b16, runs, strat);
+
+        test_operm5(0xFFFFFFFFFFFFFFFFull, b8, runs, strat);
+        test_operm5(0xFFFFFFFFFFFFFFFFull, b16, runs, strat);
+    }
+
+    for (const StrategyType &strat : strategies)
+    {
+        test_family_correlation(1000000, 64, 4096, strat);
+        test_family_correlation(b64, 64, 4096, strat);
+    }
+
+    test_grid_quality({256}, 255, runs);
+    test_grid_quality({256, 256}, 65535, runs);
+    test_grid_quality({100000, 30000, 7}, 1000000, 1);
+    test_grid_quality({1000, 1000, 1000}, 65535, runs);
+
+    for (StrategyType strat : {SUPER1, SUPER5})
+    {
+        test_batch_operm5(65535, 65535, 8, strat);
+        test_batch_operm5(0xFFFFFFFFFFFFFFFFull, 65535, 8, strat);
+    }
+
+    // Bits, runs, gap, serial pairs and birthday spacings in one pass
+    for (const StrategyType &strat : strategies)
+    {
+        test_battery(b32, (1 << 20) - 1, strat);
+        test_battery(b64, (1 << 20) - 1, strat);
+    }
+
+    for (const StrategyType &strat : strategies)
+    {
+        test_uniform(b8, b8, runs, strat);
+
+        test_uniform(b16, b8, runs, strat);
+        test_uniform(b16, b16, runs, strat);
+
+        test_uniform(100 * 1000000, 1000000, 1, strat);
+
+        test_uniform(b32, b8, runs, strat);
+        test_uniform(b32, b16, runs, strat);
+
+        test_uniform(0xFFFFFFFFFFFFFFFFull, b8, runs, strat);
+        test_uniform(0xFFFFFFFFFFFFFFFFull, b16, runs, strat);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    std::vector<StrategyType> strategies = {SUPER1, SUPER2, SUPER3, SUPER4, SUPER5};
+
+    printf("Short unit tests ... \n");
+    SHORT_UNIT_TEST(strategies);
+    printf("Distributed sampler tests ... \n");
+    SAMPLER_UNIT_TEST(strategies);
+    printf("Big unit tests (takes several minutes)... \n");
+    BIG_UNIT_TEST(strategies);
+    printf("Random test score (takes several minutes) ... \n");
+    RANDOM_TEST(strategies);
+    printf("128-bit words tests ... \n");
+    WIDE_UNIT_TEST(strategies);
+
+    // Time test
     uint64_t b064 = 0xFFFFFFFFFFFFFFFFull;
     printf("Benchmark time. May take a few seconds ... \n");
     for (const StrategyType &strat : strategies)
     {
         test_speed(b064, 10000, 1, strat);
+        test_speed128(~(uint128_t)0, 10000, 1, strat);
+    }
+    test_speed(b064, 10000, 1, SORTED);
+    test_speed(b064, 10000, 1, AUTO);
+    for (const StrategyType &strat : strategies)
+    {
+        test_construction_speed(1000000, 1000, 10000, strat);
+        test_construction_speed(b064, 1000, 10000, strat);
+    }
+    for (const StrategyType &strat : strategies)
+    {
+        test_prefetch_latency(b064, 2000, 50, strat);
+    }
+    test_grid_speed({100000, 30000, 7}, 1000000, SUPER1);
+    test_grid_speed({100000, 30000, 7}, 1000000, SUPER5);
+    test_grid_speed({1000, 1000}, 999999, SUPER5);
+    // From 1 MB to 64 GB, as long as src and dst take at most half of the RAM
+    const uint64_t ram = (uint64_t)sysconf(_SC_PHYS_PAGES) * (uint64_t)sysconf(_SC_PAGESIZE);
+    for (uint64_t mb = 1; mb <= 65536; mb *= 4)
+    {
+        if ((mb << 20) > ram / 4)
+        {
+            printf("SHUFFLE TEST: %lu MB and above skipped, %lu MB of RAM\n", mb, ram >> 20);
+            break;
+        }
+        test_shuffle_speed(mb << 20, SUPER5);
+    }
+    test_locality_mmap(256 << 20, SUPER5);
+    test_growing_speed(1, 1 << 24, SUPER5);
+    test_growing_speed(4096, 1 << 12, SUPER5);
+    test_split_speed((1 << 24) - 1, SUPER5);
+    test_battery_speed(1 << 24);
+    test_stratified_speed(500, 1000);
+    for (StrategyType strat : {SUPER2, SUPER3, SUPER4})
+    {
+        test_round_table_speed(4095, strat);
+        test_round_table_speed(32768, strat);
+        test_round_table_speed((1 << 24) - 1, strat);
+        test_round_table_speed(0xFFFFFFFFull, strat);
+    }
+    for (StrategyType strat : {SUPER1, SUPER5})
+    {
+        test_fill_narrow_speed<uint16_t>(65535, strat);
+        test_fill_narrow_speed<uint32_t>((1 << 24) - 1, strat);
+    }
+    for (StrategyType strat : {SUPER1, SUPER5})
+    {
+        test_batch_speed(b064, 1024, 256, 2000, strat);
+        test_batch_speed(1000000, 1024, 256, 2000, strat);
     }
 
     /*